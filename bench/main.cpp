@@ -0,0 +1,1453 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "chunkedrenderer.h"
+#include "columnartextable.h"
+#include "csvreader.h"
+#include "lazytextable.h"
+#include "mappedtextable.h"
+#include "sparsetextable.h"
+#include "textable.h"
+#include "textablebuilder.h"
+#include "textableview.h"
+#include "typedtextable.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <clocale>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/// The size of the allocated block header, that keeps the block size.
+const size_t allocationHeader = sizeof(std::max_align_t);
+
+/// The number of bytes currently allocated with the operator new.
+std::atomic<size_t> allocatedBytes{ 0 };
+
+/// The maximum number of allocated bytes since the last `resetPeakMemory()` call.
+std::atomic<size_t> peakBytes{ 0 };
+
+/// The number of the operator new calls.
+std::atomic<size_t> allocationCount{ 0 };
+
+} // namespace
+
+// Replace the global allocation functions to track the memory use. Array versions
+// call these ones by default. GCC takes the blocks for the objects operator new
+// returns, and warns about the header access and free() once the operators are inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Warray-bounds"
+#   if __GNUC__ >= 11
+#       pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#   endif
+#endif
+
+void *operator new(std::size_t size)
+{
+    auto block = static_cast<char *>(std::malloc(size + allocationHeader));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    std::memcpy(block, &size, sizeof(size));
+    ++allocationCount;
+
+    const auto allocated = allocatedBytes += size;
+    auto peak = peakBytes.load();
+    while (allocated > peak && !peakBytes.compare_exchange_weak(peak, allocated)) {
+    }
+    return block + allocationHeader;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (!pointer) {
+        return;
+    }
+    auto block = static_cast<char *>(pointer) - allocationHeader;
+    size_t size = 0;
+    std::memcpy(&size, block, sizeof(size));
+    allocatedBytes -= size;
+    std::free(block);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+/// The output format of the benchmark results.
+enum class Format
+{
+    Text, ///< Human readable text only
+    Json, ///< JSON array of results
+    Csv   ///< CSV lines of results
+};
+
+/// A single benchmark measurement.
+struct Result
+{
+    std::string m_name;
+    double m_value;
+    const char *m_unit;
+};
+
+std::vector<Result> results;
+
+/// The human readable output. It goes to stderr when a machine readable format is requested.
+std::FILE *logFile = stdout;
+
+/// Prints the human readable output.
+void print(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    std::vfprintf(logFile, format, arguments);
+    va_end(arguments);
+}
+
+/// Records the benchmark result of the given \p name.
+void record(const std::string &name, double value, const char *unit)
+{
+    results.push_back({ name, value, unit });
+}
+
+/// Resets the peak memory to the current allocated memory and returns it.
+size_t resetPeakMemory()
+{
+    const auto allocated = allocatedBytes.load();
+    peakBytes = allocated;
+    return allocated;
+}
+
+/// Runs the \p function \p iterations times and returns the best run time in nanoseconds.
+template<typename Function>
+double measure(Function &&function, int iterations = 5)
+{
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = Clock::now();
+        function();
+        const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (i == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+Textable makeTable(Textable::RowNumber rows, Textable::ColumnNumber columns)
+{
+    Textable textable;
+    for (Textable::RowNumber r = 0; r < rows; ++r) {
+        for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+            textable.setCell(r, c, Textable::Align::Center, "cell " + std::to_string(r * columns + c));
+        }
+    }
+    return textable;
+}
+
+/// Checks that the rendering time grows linearly with the number of rows.
+bool renderScaling()
+{
+    static const Textable::ColumnNumber columns = 8;
+    static const Textable::RowNumber sizes[] = { 1000, 4000, 16000, 64000 };
+
+    print("Render scaling (%u columns)\n", static_cast<unsigned>(columns));
+
+    double firstPerRow = 0.0;
+    double lastPerRow = 0.0;
+    for (auto rows : sizes) {
+        const auto textable = makeTable(rows, columns);
+        size_t bytes = 0;
+        const auto ns = measure([&]() { bytes += textable.toString().size(); });
+        const auto perRow = ns / rows;
+        print("  rows: %8u  total: %12.0f ns  per row: %8.1f ns\n",
+              static_cast<unsigned>(rows), ns, perRow);
+        record("render_scaling/rows_" + std::to_string(rows), perRow, "ns/row");
+        if (firstPerRow == 0.0) {
+            firstPerRow = perRow;
+        }
+        lastPerRow = perRow;
+    }
+
+    // A quadratic algorithm would increase the per row cost 64 times here.
+    static const double maxRatio = 3.0;
+    const auto ratio = lastPerRow / firstPerRow;
+    print("  per row cost ratio: %.2f (limit %.2f)\n", ratio, maxRatio);
+    return ratio <= maxRatio;
+}
+
+/// The string width calculation used before the Unicode class, for comparison.
+size_t mbstowcsWidth(const std::string &string)
+{
+#if defined (_MSC_VER)
+    size_t size = 0;
+    if (mbstowcs_s(&size, NULL, 0, string.c_str(), 0) == 0) {
+        size--; // Consider the null-terminator too.
+    }
+    return size;
+#else
+    return std::mbstowcs(NULL, string.c_str(), string.size());
+#endif
+}
+
+/// Compares the display width calculation with the locale dependent std::mbstowcs().
+bool stringWidth()
+{
+    // std::mbstowcs() requires a UTF-8 locale.
+    if (!std::setlocale(LC_ALL, "en_US.utf8") && !std::setlocale(LC_ALL, "C.UTF-8")) {
+        print("String width: no UTF-8 locale available, skipped\n");
+        return true;
+    }
+
+    struct Data
+    {
+        const char *m_name;
+        std::vector<std::string> m_strings;
+    };
+
+    const Data sets[] = {
+        { "ascii",    { "Unicode", "Column 1", "A Single Value", "height: 1.8", "length: 5.4321" } },
+        { "cyrillic", { u8"Fünf", u8"Двадцать пять", u8"Հայաստան", u8"Сто двадцать", u8"Երևան" } },
+        { "cjk",      { u8"日本語", u8"中文字符", u8"한국어 텍스트", u8"東京都", u8"北京市" } }
+    };
+
+    static const int repeat = 100000;
+
+    print("String width (%d iterations per string)\n", repeat);
+    for (const auto &set : sets) {
+        size_t total = 0;
+        const auto mbstowcsNs = measure([&]() {
+            for (int i = 0; i < repeat; ++i) {
+                for (const auto &string : set.m_strings) {
+                    total += mbstowcsWidth(string);
+                }
+            }
+        });
+        const auto unicodeNs = measure([&]() {
+            for (int i = 0; i < repeat; ++i) {
+                for (const auto &string : set.m_strings) {
+                    total += Unicode::displayWidth(string);
+                }
+            }
+        });
+        const auto count = static_cast<double>(repeat * set.m_strings.size());
+        print("  %-9s mbstowcs: %7.1f ns/string  Unicode: %7.1f ns/string  speedup: %.1fx\n",
+              set.m_name, mbstowcsNs / count, unicodeNs / count, mbstowcsNs / unicodeNs);
+        record(std::string("string_width/mbstowcs/") + set.m_name, mbstowcsNs / count, "ns/string");
+        record(std::string("string_width/unicode/") + set.m_name, unicodeNs / count, "ns/string");
+        if (total == 0) {
+            return false;
+        }
+    }
+
+    std::setlocale(LC_ALL, "C");
+    return true;
+}
+
+/// The stream based rendering used before the Renderer class, for comparison.
+/*!
+    Implemented with the public API, and assumes that all cells are center aligned.
+*/
+std::string streamRender(const Textable &table)
+{
+    std::ostringstream os;
+    if (table.rowCount() == 0) {
+        return os.str();
+    }
+
+    std::vector<size_t> widths(table.columnCount(), 0);
+    for (Textable::RowNumber r = 0; r < table.rowCount(); ++r) {
+        for (Textable::ColumnNumber c = 0; c < table.columnCount(); ++c) {
+            widths[c] = std::max(widths[c], Unicode::displayWidth(table.cellData(r, c)) + 2);
+        }
+    }
+
+    auto drawLine = [&]() {
+        os << '+';
+        for (auto width : widths) {
+            os << std::string(width, '-') << '+';
+        }
+        os << '\n';
+    };
+
+    drawLine();
+    for (Textable::RowNumber r = 0; r < table.rowCount(); ++r) {
+        os << '|';
+        for (Textable::ColumnNumber c = 0; c < table.columnCount(); ++c) {
+            const auto data = table.cellData(r, c);
+            const auto spaceCount = widths[c] - Unicode::displayWidth(data);
+            const auto leftSpace = spaceCount / 2;
+            os << std::string(leftSpace, ' ') << data << std::string(spaceCount - leftSpace, ' ') << '|';
+        }
+        os << '\n';
+        drawLine();
+    }
+    return os.str();
+}
+
+/// Compares the single allocation toString() with the stream based rendering.
+bool renderToString()
+{
+    static const Textable::RowNumber rows = 20000;
+    static const Textable::ColumnNumber columns = 8;
+    const auto textable = makeTable(rows, columns);
+
+    if (streamRender(textable) != textable.toString()) {
+        print("Render to string: output mismatch\n");
+        return false;
+    }
+
+    size_t bytes = 0;
+    const auto streamNs = measure([&]() { bytes += streamRender(textable).size(); });
+    const auto toStringNs = measure([&]() { bytes += textable.toString().size(); });
+    std::string buffer(textable.renderedSize(), ' ');
+    const auto renderToNs = measure([&]() { bytes += textable.renderTo(&buffer[0], buffer.size()); });
+
+    print("Render to string (%u x %u)\n", static_cast<unsigned>(rows), static_cast<unsigned>(columns));
+    print("  stream:     %12.0f ns\n", streamNs);
+    print("  toString(): %12.0f ns  speedup: %.1fx\n", toStringNs, streamNs / toStringNs);
+    print("  renderTo(): %12.0f ns  speedup: %.1fx\n", renderToNs, streamNs / renderToNs);
+    record("render/stream", streamNs, "ns");
+    record("render/to_string", toStringNs, "ns");
+    record("render/render_to", renderToNs, "ns");
+    return bytes > 0;
+}
+
+/// Measures the parallel rendering scalability.
+bool parallelRender()
+{
+    static const Textable::RowNumber rows = 200000;
+    static const Textable::ColumnNumber columns = 24;
+    const auto textable = makeTable(rows, columns);
+    const auto expected = textable.toString();
+
+    print("Parallel render (%u x %u)\n", static_cast<unsigned>(rows), static_cast<unsigned>(columns));
+
+    const auto maxThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    double serialNs = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        std::string buffer(expected.size(), ' ');
+        const auto ns = measure([&]() { textable.renderTo(&buffer[0], buffer.size(), threads); });
+        if (buffer != expected) {
+            print("  threads: %u output mismatch\n", threads);
+            return false;
+        }
+        if (threads == 1) {
+            serialNs = ns;
+        }
+        print("  threads: %3u  %12.0f ns  speedup: %.2fx\n", threads, ns, serialNs / ns);
+        record("parallel_render/threads_" + std::to_string(threads), ns, "ns");
+    }
+    return true;
+}
+
+/// Measures the ingestion of numeric values compared with the stream based conversion.
+bool numericIngestion()
+{
+    static const Textable::RowNumber rows = 20000;
+    const std::vector<int> integers{ 1, -22, 333, 4444, -55555, 666666, 7, 88 };
+    const std::vector<double> doubles{ 0.0, 1.1, -2.25, 3e10, 4.5e-5, 123456.789, 7.0, 0.125 };
+
+    auto toString = [](double value) {
+        std::ostringstream stream;
+        stream << value;
+        return stream.str();
+    };
+
+    size_t cells = 0;
+    const auto streamNs = measure([&]() {
+        Textable textable;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            for (Textable::ColumnNumber c = 0; c < integers.size(); ++c) {
+                textable.setCell(r, c, Textable::Align::Right, toString(integers[c]));
+                textable.setCell(r, c + integers.size(), Textable::Align::Right, toString(doubles[c]));
+            }
+        }
+        cells += textable.rowCount();
+    });
+    const auto directNs = measure([&]() {
+        Textable textable;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            for (Textable::ColumnNumber c = 0; c < integers.size(); ++c) {
+                textable.setCell(r, c, Textable::Align::Right, integers[c]);
+                textable.setCell(r, c + integers.size(), Textable::Align::Right, doubles[c]);
+            }
+        }
+        cells += textable.rowCount();
+    });
+
+    const auto count = static_cast<double>(rows * (integers.size() + doubles.size()));
+    print("Numeric ingestion (%u rows, int and double)\n", static_cast<unsigned>(rows));
+    print("  ostringstream: %7.1f ns/cell\n", streamNs / count);
+    print("  setCell():     %7.1f ns/cell  speedup: %.1fx\n", directNs / count, streamNs / directNs);
+    record("numeric_ingestion/ostringstream", streamNs / count, "ns/cell");
+    record("numeric_ingestion/set_cell", directNs / count, "ns/cell");
+    return cells > 0;
+}
+
+/// Compares the ingestion and rendering of a fixed schema with the typed table.
+bool typedTable()
+{
+    static const Textable::RowNumber rows = 20000;
+
+    using Typed = TypedTextable<TypedColumn<std::string, Textable::Align::Left>,
+                                TypedColumn<int, Textable::Align::Right>,
+                                TypedColumn<double, Textable::Align::Right>,
+                                bool>;
+    const std::string name("name");
+
+    std::string textableOutput;
+    const auto textableNs = measure([&]() {
+        Textable textable;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            textable.setRow(r, Textable::Align::Right, name, static_cast<int>(r), r * 0.5, r % 2 == 0);
+        }
+        textableOutput = textable.toString();
+    });
+
+    std::string typedOutput;
+    const auto typedNs = measure([&]() {
+        Typed typed;
+        typed.reserve(rows);
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            typed.addRow(name, static_cast<int>(r), r * 0.5, r % 2 == 0);
+        }
+        typedOutput = typed.toString();
+    });
+
+    print("Typed table (%u rows, ingestion and rendering)\n", static_cast<unsigned>(rows));
+    print("  Textable::setRow():         %7.1f ns/row\n", textableNs / rows);
+    print("  TypedTextable::addRow():    %7.1f ns/row  speedup: %.1fx\n", typedNs / rows,
+          textableNs / typedNs);
+    record("typed_table/textable", textableNs / rows, "ns/row");
+    record("typed_table/typed_textable", typedNs / rows, "ns/row");
+    return typedOutput.size() == textableOutput.size();
+}
+
+/// A stream buffer that discards everything written.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    std::streamsize xsputn(const char *, std::streamsize size) override
+    {
+        return size;
+    }
+};
+
+/// Measures the ingestion, rendering and memory use for tall and wide tables of ASCII and
+/// multi-byte texts.
+bool shapesAndData()
+{
+    struct Shape
+    {
+        const char *m_name;
+        Textable::RowNumber m_rows;
+        Textable::ColumnNumber m_columns;
+    };
+
+    struct Data
+    {
+        const char *m_name;
+        const char *m_prefix;
+    };
+
+    // The variadic packs are four values long, so are the narrow dimensions.
+    const Shape shapes[] = { { "tall", 5000, 4 }, { "wide", 4, 5000 } };
+    const Data sets[] = { { "ascii", "cell " }, { "unicode", u8"ячейка " } };
+
+    static const auto align = Textable::Align::Center;
+    bool ok = true;
+
+    print("Shapes and data (ns/cell, bytes/cell)\n");
+    for (const auto &shape : shapes) {
+        for (const auto &set : sets) {
+            const auto rows = shape.m_rows;
+            const auto columns = shape.m_columns;
+            const auto cells = rows * columns;
+
+            // Prepare the texts up front, to measure the table operations only.
+            std::vector<std::string> values(cells);
+            for (size_t i = 0; i < cells; ++i) {
+                values[i] = set.m_prefix + std::to_string(i);
+            }
+            auto value = [&](Textable::RowNumber r, Textable::ColumnNumber c) -> const std::string & {
+                return values[r * columns + c];
+            };
+
+            std::vector<size_t> order(cells);
+            for (size_t i = 0; i < cells; ++i) {
+                order[i] = i;
+            }
+            std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+            const auto prefix = std::string(shape.m_name) + '/' + set.m_name + '/';
+            auto report = [&](const char *name, double ns) {
+                print("  %-5s %-8s %-22s %9.1f ns/cell\n", shape.m_name, set.m_name, name, ns / cells);
+                record(prefix + name, ns / cells, "ns/cell");
+            };
+
+            std::string expected;
+            auto check = [&](const Textable &textable) {
+                const auto output = textable.toString();
+                if (expected.empty()) {
+                    expected = output;
+                } else if (output != expected) {
+                    ok = false;
+                }
+            };
+
+            report("set_cell", measure([&]() {
+                Textable textable;
+                for (Textable::RowNumber r = 0; r < rows; ++r) {
+                    for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                        textable.setCell(r, c, align, value(r, c));
+                    }
+                }
+                check(textable);
+            }));
+
+            report("set_cell_random", measure([&]() {
+                Textable textable;
+                for (auto i : order) {
+                    textable.setCell(i / columns, i % columns, align, values[i]);
+                }
+                check(textable);
+            }));
+
+            report("set_row_container", measure([&]() {
+                Textable textable;
+                std::vector<std::string> row(columns);
+                for (Textable::RowNumber r = 0; r < rows; ++r) {
+                    for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                        row[c] = value(r, c);
+                    }
+                    textable.setRow(r, align, row);
+                }
+                check(textable);
+            }));
+
+            report("set_column_container", measure([&]() {
+                Textable textable;
+                std::vector<std::string> column(rows);
+                for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                    for (Textable::RowNumber r = 0; r < rows; ++r) {
+                        column[r] = value(r, c);
+                    }
+                    textable.setColumn(c, align, column);
+                }
+                check(textable);
+            }));
+
+            if (columns == 4) {
+                report("set_row_variadic", measure([&]() {
+                    Textable textable;
+                    for (Textable::RowNumber r = 0; r < rows; ++r) {
+                        textable.setRow(r, align, value(r, 0), value(r, 1), value(r, 2), value(r, 3));
+                    }
+                    check(textable);
+                }));
+            }
+
+            if (rows == 4) {
+                report("set_column_variadic", measure([&]() {
+                    Textable textable;
+                    for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                        textable.setColumn(c, align, value(0, c), value(1, c), value(2, c), value(3, c));
+                    }
+                    check(textable);
+                }));
+            }
+
+            // The memory of a table built cell by cell, at its peak.
+            const auto baseline = resetPeakMemory();
+            {
+                Textable textable;
+                for (Textable::RowNumber r = 0; r < rows; ++r) {
+                    for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                        textable.setCell(r, c, align, value(r, c));
+                    }
+                }
+
+                size_t bytes = 0;
+                report("to_string", measure([&]() { bytes += textable.toString().size(); }));
+
+                NullBuffer nullBuffer;
+                std::ostream nullStream(&nullBuffer);
+                report("stream_operator", measure([&]() { nullStream << textable; }));
+                ok = ok && bytes > 0;
+            }
+            const auto memory = static_cast<double>(peakBytes.load() - baseline) / cells;
+            print("  %-5s %-8s %-22s %9.1f bytes/cell\n", shape.m_name, set.m_name, "peak_memory", memory);
+            record(prefix + "peak_memory", memory, "bytes/cell");
+        }
+    }
+
+    if (!ok) {
+        print("  output mismatch\n");
+    }
+    return ok;
+}
+
+/// Compares the memory use and render throughput of the columnar storage with the Textable one.
+bool columnarStorage()
+{
+    static const Textable::RowNumber rows = 100000;
+    static const Textable::ColumnNumber columns = 10;
+    static const auto cells = static_cast<double>(rows * columns);
+
+    std::vector<std::string> values(columns);
+    for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+        values[c] = (c % 2 == 0 ? "value " : u8"значение ") + std::to_string(c);
+    }
+
+    print("Columnar storage (%u x %u)\n", static_cast<unsigned>(rows), static_cast<unsigned>(columns));
+
+    auto report = [&](const char *name, size_t memory, double ns, size_t bytes) {
+        const auto perCell = static_cast<double>(memory) / cells;
+        const auto throughput = bytes / ns * 1e3; // MB/s
+        print("  %-17s memory: %6.1f bytes/cell  render: %7.1f MB/s\n", name, perCell, throughput);
+        record(std::string("columnar_storage/") + name + "/memory", perCell, "bytes/cell");
+        record(std::string("columnar_storage/") + name + "/render", throughput, "MB/s");
+    };
+
+    std::string expected;
+    {
+        const auto baseline = resetPeakMemory();
+        Textable textable;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                textable.setCell(r, c, Textable::Align::Left, values[c]);
+            }
+        }
+        const auto memory = allocatedBytes.load() - baseline;
+        const auto ns = measure([&]() { expected = textable.toString(); });
+        report("Textable", memory, ns, expected.size());
+    }
+
+    std::string output;
+    {
+        const auto baseline = resetPeakMemory();
+        ColumnarTextable columnar;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                columnar.setCell(r, c, Textable::Align::Left, values[c]);
+            }
+        }
+        const auto memory = allocatedBytes.load() - baseline;
+        const auto ns = measure([&]() { output = columnar.toString(); });
+        report("ColumnarTextable", memory, ns, output.size());
+    }
+
+    return output == expected;
+}
+
+/// Compares the row order filling with and without the reservation, and the range appending.
+bool bulkIngestion()
+{
+    static const Textable::RowNumber rows = 100000;
+    static const Textable::ColumnNumber columns = 8;
+    static const auto cells = static_cast<double>(rows * columns);
+
+    struct Record
+    {
+        int m_values[columns];
+    };
+    std::vector<Record> records(rows);
+    for (Textable::RowNumber r = 0; r < rows; ++r) {
+        for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+            records[r].m_values[c] = static_cast<int>(r * columns + c);
+        }
+    }
+
+    std::string expected;
+    std::string output;
+    const auto setCellNs = measure([&]() {
+        Textable textable;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                textable.setCell(r, c, Textable::Align::Right, records[r].m_values[c]);
+            }
+        }
+        expected = textable.toString();
+    });
+    const auto reservedNs = measure([&]() {
+        Textable textable;
+        textable.reserve(rows, columns);
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+                textable.setCell(r, c, Textable::Align::Right, records[r].m_values[c]);
+            }
+        }
+        output = textable.toString();
+    });
+    bool ok = output == expected;
+
+    const auto appendNs = measure([&]() {
+        Textable textable;
+        textable.appendRows(records.begin(), records.end(), Textable::Align::Right,
+                            [](const Record &record) { return record.m_values[0]; },
+                            [](const Record &record) { return record.m_values[1]; },
+                            [](const Record &record) { return record.m_values[2]; },
+                            [](const Record &record) { return record.m_values[3]; },
+                            [](const Record &record) { return record.m_values[4]; },
+                            [](const Record &record) { return record.m_values[5]; },
+                            [](const Record &record) { return record.m_values[6]; },
+                            [](const Record &record) { return record.m_values[7]; });
+        output = textable.toString();
+    });
+    ok = ok && output == expected;
+
+    print("Bulk ingestion (%u x %u, with rendering)\n", static_cast<unsigned>(rows), static_cast<unsigned>(columns));
+    print("  setCell():              %7.1f ns/cell\n", setCellNs / cells);
+    print("  reserve() + setCell():  %7.1f ns/cell  speedup: %.2fx\n", reservedNs / cells, setCellNs / reservedNs);
+    print("  appendRows():           %7.1f ns/cell  speedup: %.2fx\n", appendNs / cells, setCellNs / appendNs);
+    record("bulk_ingestion/set_cell", setCellNs / cells, "ns/cell");
+    record("bulk_ingestion/reserve_set_cell", reservedNs / cells, "ns/cell");
+    record("bulk_ingestion/append_rows", appendNs / cells, "ns/cell");
+    return ok;
+}
+
+/// Compares the sparse table with the dense one for a few far apart cells.
+bool sparseStorage()
+{
+    static const Textable::RowNumber lastRow = 1000000;
+    static const Textable::ColumnNumber lastColumn = 50;
+
+    print("Sparse storage (cells at (0, 0), (%u, %u) and (%u, %u))\n", static_cast<unsigned>(lastRow / 2),
+          static_cast<unsigned>(lastColumn / 2), static_cast<unsigned>(lastRow), static_cast<unsigned>(lastColumn));
+
+    auto report = [&](const char *name, size_t memory, double fillNs, double renderNs) {
+        print("  %-15s memory: %12u bytes  fill: %12.0f ns  render: %12.0f ns\n", name,
+              static_cast<unsigned>(memory), fillNs, renderNs);
+        record(std::string("sparse_storage/") + name + "/memory", static_cast<double>(memory), "bytes");
+        record(std::string("sparse_storage/") + name + "/fill", fillNs, "ns");
+        record(std::string("sparse_storage/") + name + "/render", renderNs, "ns");
+    };
+
+    std::string expected;
+    {
+        const auto baseline = resetPeakMemory();
+        Textable textable;
+        const auto fillNs = measure([&]() {
+            textable.setCell(0, 0, Textable::Align::Left, "first");
+            textable.setCell(lastRow / 2, lastColumn / 2, Textable::Align::Left, "middle");
+            textable.setCell(lastRow, lastColumn, Textable::Align::Left, "last");
+        }, 1);
+        const auto memory = allocatedBytes.load() - baseline;
+        const auto renderNs = measure([&]() { expected = textable.toString(); }, 1);
+        report("Textable", memory, fillNs, renderNs);
+    }
+
+    std::string output;
+    {
+        const auto baseline = resetPeakMemory();
+        SparseTextable sparse;
+        const auto fillNs = measure([&]() {
+            sparse.setCell(0, 0, Textable::Align::Left, "first");
+            sparse.setCell(lastRow / 2, lastColumn / 2, Textable::Align::Left, "middle");
+            sparse.setCell(lastRow, lastColumn, Textable::Align::Left, "last");
+        }, 1);
+        const auto memory = allocatedBytes.load() - baseline;
+        const auto renderNs = measure([&]() { output = sparse.toString(); }, 1);
+        report("SparseTextable", memory, fillNs, renderNs);
+    }
+
+    return output == expected;
+}
+
+/// Checks that rendering a page costs the same regardless of the table size.
+bool windowRender()
+{
+    static const Textable::RowNumber pageSize = 50;
+    static const Textable::RowNumber sizes[] = { 10000, 1000000 };
+
+    print("Window render (%u rows per page, the header repeated)\n", static_cast<unsigned>(pageSize));
+
+    double firstNs = 0.0;
+    double lastNs = 0.0;
+    for (auto rows : sizes) {
+        const auto textable = makeTable(rows, 8);
+
+        Textable::Window window;
+        window.m_beginRow = rows / 2;
+        window.m_endRow = window.m_beginRow + pageSize;
+        window.m_headerRows = 1;
+
+        std::string page;
+        const auto ns = measure([&]() { page = textable.toString(window); });
+        print("  rows: %8u  page: %10.0f ns\n", static_cast<unsigned>(rows), ns);
+        record("window_render/rows_" + std::to_string(rows), ns, "ns/page");
+        if (firstNs == 0.0) {
+            firstNs = ns;
+        }
+        lastNs = ns;
+    }
+
+    // The page cost should not grow with the table size.
+    static const double maxRatio = 3.0;
+    return lastNs / firstNs <= maxRatio;
+}
+
+/// Measures the repeated rendering of an unchanged table with and without the render cache.
+bool renderCache()
+{
+    static const int scrapes = 100;
+    auto textable = makeTable(20000, 8);
+
+    size_t bytes = 0;
+    const auto uncachedNs = measure([&]() {
+        for (int i = 0; i < scrapes; ++i) {
+            bytes += textable.toString().size();
+        }
+    }, 1);
+
+    textable.setRenderCache(true);
+    const auto cachedNs = measure([&]() {
+        for (int i = 0; i < scrapes; ++i) {
+            bytes += textable.snapshot()->size();
+        }
+    }, 1);
+
+    print("Render cache (%d renderings of an unchanged 20000 x 8 table)\n", scrapes);
+    print("  toString():             %12.0f ns/call\n", uncachedNs / scrapes);
+    print("  cached snapshot():      %12.0f ns/call  speedup: %.0fx\n", cachedNs / scrapes, uncachedNs / cachedNs);
+    record("render_cache/uncached", uncachedNs / scrapes, "ns/call");
+    record("render_cache/cached", cachedNs / scrapes, "ns/call");
+    return bytes > 0;
+}
+
+/// Measures the re-rendering of a table after a few cells of it change.
+bool renderChanges()
+{
+    static const int ticks = 100;
+    static const int changesPerTick = 10;
+    static const Textable::RowNumber rows = 20000;
+    auto textable = makeTable(rows, 8);
+
+    // The updated values are not wider than the existing ones, so the column widths are stable.
+    int tick = 0;
+    auto update = [&]() {
+        for (int i = 0; i < changesPerTick; ++i) {
+            const auto row = static_cast<Textable::RowNumber>((tick * 7919 + i * 104729) % rows);
+            textable.setCell(row, i % 8, Textable::Align::Center, "tick " + std::to_string(tick));
+        }
+        ++tick;
+    };
+
+    size_t bytes = 0;
+    const auto fullNs = measure([&]() {
+        for (int i = 0; i < ticks; ++i) {
+            update();
+            bytes += textable.toString().size();
+        }
+    }, 1);
+
+    std::string output;
+    textable.renderChanges(output);
+    const auto incrementalNs = measure([&]() {
+        for (int i = 0; i < ticks; ++i) {
+            update();
+            bytes += textable.renderChanges(output).size();
+        }
+    }, 1);
+
+    print("Incremental render (%d changed cells per update of a %u x 8 table)\n",
+          changesPerTick, static_cast<unsigned>(rows));
+    print("  toString():             %12.0f ns/update\n", fullNs / ticks);
+    print("  renderChanges():        %12.0f ns/update  speedup: %.0fx\n",
+          incrementalNs / ticks, fullNs / incrementalNs);
+    record("render_changes/full", fullNs / ticks, "ns/update");
+    record("render_changes/incremental", incrementalNs / ticks, "ns/update");
+    return bytes > 0 && output == textable.toString() && incrementalNs < fullNs;
+}
+
+/// Runs \p threadCount threads that call the \p produce function with their index.
+template<typename Function>
+void runThreads(unsigned threadCount, Function &&produce)
+{
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back(produce, t);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/// Compares the concurrent ingestion through the builder with a table guarded by a mutex.
+bool concurrentBuild()
+{
+    static const unsigned rows = 200000;
+
+    print("Concurrent build (%u rows split between the threads)\n", rows);
+
+    const auto maxThreads = std::max(std::thread::hardware_concurrency(), 4U);
+    bool ok = true;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        const auto rowsPerThread = rows / threads;
+
+        Textable::RowNumber lockedRows = 0;
+        const auto lockedNs = measure([&]() {
+            Textable textable;
+            std::mutex mutex;
+            runThreads(threads, [&](unsigned t) {
+                for (unsigned i = 0; i < rowsPerThread; ++i) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    textable.appendRow(Textable::Align::Left, t, i, "cell value");
+                }
+            });
+            lockedRows = textable.rowCount();
+        }, 3);
+
+        Textable::RowNumber builtRows = 0;
+        double spliceNs = 0.0;
+        const auto builderNs = measure([&]() {
+            TextableBuilder builder;
+            runThreads(threads, [&](unsigned t) {
+                for (unsigned i = 0; i < rowsPerThread; ++i) {
+                    builder.appendRow(Textable::Align::Left, t, i, "cell value");
+                }
+            });
+            const auto start = Clock::now();
+            const auto textable = builder.build();
+            spliceNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            builtRows = textable.rowCount();
+        }, 3);
+
+        print("  threads: %3u  mutex: %12.0f ns  builder: %12.0f ns  (build: %10.0f ns)  speedup: %.2fx\n",
+              threads, lockedNs, builderNs, spliceNs, lockedNs / builderNs);
+        record("concurrent_build/mutex_threads_" + std::to_string(threads), lockedNs, "ns");
+        record("concurrent_build/builder_threads_" + std::to_string(threads), builderNs, "ns");
+        ok = ok && lockedRows == rowsPerThread * threads && builtRows == lockedRows;
+    }
+    return ok;
+}
+
+/// Compares the CSV import with the line by line parsing into setRow().
+bool csvImport()
+{
+    static const int rows = 400000;
+    static const char *path = "textable_bench.csv";
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (int r = 0; r < rows; ++r) {
+            file << r << ",name " << r % 1000 << ",\"quoted, field\"," << r * 0.5 << ",description of the record "
+                 << r << "\n";
+        }
+    }
+    std::ifstream probe(path, std::ios::binary | std::ios::ate);
+    const auto megabytes = static_cast<double>(probe.tellg()) / (1024 * 1024);
+
+    Textable::RowNumber lineRows = 0;
+    const auto lineNs = measure([&]() {
+        Textable textable;
+        std::ifstream file(path, std::ios::binary);
+        std::string line;
+        Textable::RowNumber row = 0;
+        while (std::getline(file, line)) {
+            // A naive split that doesn't support quotes.
+            std::istringstream stream(line);
+            std::vector<std::string> fields;
+            std::string field;
+            while (std::getline(stream, field, ',')) {
+                fields.push_back(field);
+            }
+            textable.setRow(row++, Textable::Align::Left, fields);
+        }
+        lineRows = textable.rowCount();
+    }, 1);
+
+    print("CSV import (%.1f MB, %d rows)\n", megabytes, rows);
+    print("  getline() + setRow():   %8.1f MB/s\n", megabytes / (lineNs * 1e-9));
+    record("csv_import/getline", megabytes / (lineNs * 1e-9), "MB/s");
+
+    bool ok = lineRows == static_cast<Textable::RowNumber>(rows);
+    const auto maxThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        CsvReader::Options options;
+        options.m_threadCount = threads;
+        const CsvReader reader(options);
+
+        Textable::RowNumber importedRows = 0;
+        const auto ns = measure([&]() {
+            Textable textable;
+            ok = reader.read(path, textable) && ok;
+            importedRows = textable.rowCount();
+        }, 3);
+        print("  CsvReader, threads: %3u %8.1f MB/s  speedup: %.1fx\n",
+              threads, megabytes / (ns * 1e-9), lineNs / ns);
+        record("csv_import/threads_" + std::to_string(threads), megabytes / (ns * 1e-9), "MB/s");
+        ok = ok && importedRows == lineRows;
+    }
+
+    std::remove(path);
+    return ok;
+}
+
+/// Measures the allocations of building and rendering many small tables, one per request.
+bool requestTables()
+{
+    static const int requests = 10000;
+    static const int rows = 20;
+
+    const std::vector<std::string> names{ "request handler name", "another handler name", "a third handler" };
+
+    auto fill = [&names](Textable &textable, int request) {
+        textable.appendRow(Textable::Align::Left, "Handler", "Calls", "Latency, ms");
+        for (int r = 0; r < rows; ++r) {
+            textable.appendRow(Textable::Align::Left, names[r % names.size()], request + r, r * 0.25);
+        }
+    };
+
+    std::string output;
+    size_t bytes = 0;
+    auto render = [&output, &bytes](const Textable &textable) {
+        output.resize(textable.renderedSize());
+        bytes += textable.renderTo(&output[0], output.size());
+    };
+
+    auto before = allocationCount.load();
+    const auto freshNs = measure([&]() {
+        for (int i = 0; i < requests; ++i) {
+            Textable textable;
+            fill(textable, i);
+            render(textable);
+        }
+    }, 1);
+    const auto freshAllocations = static_cast<double>(allocationCount - before) / requests;
+
+    Textable::MemoryPool pool;
+    before = allocationCount.load();
+    const auto pooledNs = measure([&]() {
+        for (int i = 0; i < requests; ++i) {
+            Textable textable(pool);
+            fill(textable, i);
+            render(textable);
+        }
+    }, 1);
+    const auto pooledAllocations = static_cast<double>(allocationCount - before) / requests;
+
+    Textable reused;
+    before = allocationCount.load();
+    const auto reusedNs = measure([&]() {
+        for (int i = 0; i < requests; ++i) {
+            reused.clear();
+            fill(reused, i);
+            render(reused);
+        }
+    }, 1);
+    const auto reusedAllocations = static_cast<double>(allocationCount - before) / requests;
+
+    print("Request tables (%d requests, %d x 3 tables)\n", requests, rows + 1);
+    print("  new table per request:  %8.0f ns/request  %6.1f allocations/request\n",
+          freshNs / requests, freshAllocations);
+    print("  new table with a pool:  %8.0f ns/request  %6.1f allocations/request\n",
+          pooledNs / requests, pooledAllocations);
+    print("  reused with clear():    %8.0f ns/request  %6.1f allocations/request\n",
+          reusedNs / requests, reusedAllocations);
+    record("request_tables/fresh", freshNs / requests, "ns/request");
+    record("request_tables/fresh_allocations", freshAllocations, "allocations/request");
+    record("request_tables/pooled", pooledNs / requests, "ns/request");
+    record("request_tables/pooled_allocations", pooledAllocations, "allocations/request");
+    record("request_tables/reused", reusedNs / requests, "ns/request");
+    record("request_tables/reused_allocations", reusedAllocations, "allocations/request");
+    return bytes > 0 && reusedAllocations < freshAllocations && pooledAllocations < freshAllocations;
+}
+
+/// Compares the ingestion of a numeric table converted at once and at the render time.
+bool lazyCells()
+{
+    static const Textable::RowNumber rows = 200000;
+    static const Textable::ColumnNumber columns = 8;
+    static const auto cells = static_cast<double>(rows * columns);
+
+    print("Lazy cells (%u x %u numbers)\n", static_cast<unsigned>(rows), static_cast<unsigned>(columns));
+
+    auto report = [&](const char *name, size_t memory, double ingestNs, double renderNs) {
+        print("  %-13s ingestion: %6.1f ns/cell  memory: %6.1f bytes/cell  first render: %6.1f ns/cell\n",
+              name, ingestNs / cells, static_cast<double>(memory) / cells, renderNs / cells);
+        record(std::string("lazy_cells/") + name + "/ingestion", ingestNs / cells, "ns/cell");
+        record(std::string("lazy_cells/") + name + "/memory", static_cast<double>(memory) / cells, "bytes/cell");
+        record(std::string("lazy_cells/") + name + "/render", renderNs / cells, "ns/cell");
+    };
+
+    std::string expected;
+    {
+        const auto baseline = resetPeakMemory();
+        Textable textable;
+        const auto ingestNs = measure([&]() {
+            for (Textable::RowNumber r = 0; r < rows; ++r) {
+                const auto i = static_cast<long long>(r);
+                textable.setRow(r, Textable::Align::Right, i, i * 7, i * 0.5, i * 1.25e-3,
+                                i % 2 == 0, i * 31, -i, i / 3.0);
+            }
+        }, 1);
+        const auto memory = allocatedBytes.load() - baseline;
+        const auto renderNs = measure([&]() { expected = textable.toString(); }, 1);
+        report("Textable", memory, ingestNs, renderNs);
+    }
+
+    std::string output;
+    {
+        const auto baseline = resetPeakMemory();
+        LazyTextable lazy;
+        const auto ingestNs = measure([&]() {
+            for (Textable::RowNumber r = 0; r < rows; ++r) {
+                const auto i = static_cast<long long>(r);
+                lazy.setRow(r, Textable::Align::Right, i, i * 7, i * 0.5, i * 1.25e-3,
+                            i % 2 == 0, i * 31, -i, i / 3.0);
+            }
+        }, 1);
+        const auto memory = allocatedBytes.load() - baseline;
+        const auto renderNs = measure([&]() { output = lazy.toString(); }, 1);
+        report("LazyTextable", memory, ingestNs, renderNs);
+    }
+
+    // The cells wider than 2^25 columns are kept whole, as Textable does.
+    const std::string wide((1U << 25) + 5, 'x');
+    LazyTextable lazy;
+    lazy.setCell(0, 0, Textable::Align::Left, wide);
+    lazy.setCell(1, 0, Textable::Align::Left, 42);
+
+    return output == expected && lazy.cellData(0, 0) == wide &&
+           lazy.toString().size() == 5 * (wide.size() + 5);
+}
+
+bool sortedViews()
+{
+    static const Textable::RowNumber rows = 200000;
+
+    print("Sorted views (%u rows, sort by a numeric column and filter)\n", static_cast<unsigned>(rows));
+
+    Textable textable;
+    textable.appendRow(Textable::Align::Left, "Id", "Name", "Amount", "Status");
+    std::mt19937 random(7);
+    for (Textable::RowNumber r = 0; r < rows; ++r) {
+        textable.appendRow(Textable::Align::Right, r, "name " + std::to_string(random() % 10000),
+                           static_cast<double>(random() % 1000000) / 100, r % 3 == 0 ? "closed" : "open");
+    }
+
+    // Copying the rows into a new table in the sorted order.
+    std::string expected;
+    size_t copyBytes = 0;
+    const auto copyNs = measure([&]() {
+        const auto baseline = resetPeakMemory();
+        std::vector<Textable::RowNumber> order;
+        std::vector<double> keys(textable.rowCount());
+        for (Textable::RowNumber r = 1; r < textable.rowCount(); ++r) {
+            if (textable.cellData(r, 3) == "open") {
+                order.push_back(r);
+                keys[r] = std::strtod(textable.cellData(r, 2).c_str(), nullptr);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&keys](Textable::RowNumber left, Textable::RowNumber right) {
+            return keys[left] < keys[right];
+        });
+        Textable sorted;
+        sorted.appendRow(Textable::Align::Left, "Id", "Name", "Amount", "Status");
+        for (auto r : order) {
+            sorted.appendRow(Textable::Align::Right, textable.cellData(r, 0), textable.cellData(r, 1),
+                             textable.cellData(r, 2), textable.cellData(r, 3));
+        }
+        expected = sorted.toString();
+        copyBytes = peakBytes.load() - baseline;
+    }, 3);
+
+    std::string output;
+    size_t viewBytes = 0;
+    const auto viewNs = measure([&]() {
+        const auto baseline = resetPeakMemory();
+        TextableView view(textable, 1);
+        view.filter([](const Textable::Row &row) { return row[3].m_data == "open"; }).sort(2);
+        output = view.toString();
+        viewBytes = peakBytes.load() - baseline;
+    }, 3);
+
+    print("  copied table: %8.2f ms  peak memory: %7.1f MB\n", copyNs / 1e6, static_cast<double>(copyBytes) / 1e6);
+    print("  view:         %8.2f ms  peak memory: %7.1f MB  (%.1fx faster)\n", viewNs / 1e6,
+          static_cast<double>(viewBytes) / 1e6, copyNs / viewNs);
+    record("sorted_views/copy", copyNs / 1e6, "ms");
+    record("sorted_views/view", viewNs / 1e6, "ms");
+    record("sorted_views/copy_memory", static_cast<double>(copyBytes) / 1e6, "MB");
+    record("sorted_views/view_memory", static_cast<double>(viewBytes) / 1e6, "MB");
+
+    return output == expected;
+}
+
+bool chunkedRender()
+{
+    static const Textable::RowNumber rows = 200000;
+    static const Textable::ColumnNumber columns = 8;
+    static const size_t chunkSize = 16384;
+    const auto textable = makeTable(rows, columns);
+
+    print("Chunked render (%u x %u, %u byte chunks)\n", static_cast<unsigned>(rows),
+          static_cast<unsigned>(columns), static_cast<unsigned>(chunkSize));
+
+    // Both feed a sink that takes a chunk at a time, like a non-blocking socket does.
+    uint64_t checksum = 0;
+    auto consume = [&checksum](const char *data, size_t size) {
+        for (size_t i = 0; i < size; i += 512) {
+            checksum += static_cast<unsigned char>(data[i]);
+        }
+    };
+
+    uint64_t expected = 0;
+    size_t wholeBytes = 0;
+    const auto wholeNs = measure([&]() {
+        checksum = 0;
+        const auto baseline = resetPeakMemory();
+        const auto output = textable.toString();
+        for (size_t offset = 0; offset < output.size(); offset += chunkSize) {
+            consume(output.data() + offset, std::min(chunkSize, output.size() - offset));
+        }
+        wholeBytes = peakBytes.load() - baseline;
+        expected = checksum;
+    }, 3);
+
+    size_t chunkedBytes = 0;
+    const auto chunkedNs = measure([&]() {
+        checksum = 0;
+        const auto baseline = resetPeakMemory();
+        ChunkedRenderer renderer(textable);
+        std::vector<char> buffer(chunkSize);
+        while (!renderer.done()) {
+            consume(buffer.data(), renderer.next(buffer.data(), buffer.size()));
+        }
+        chunkedBytes = peakBytes.load() - baseline;
+    }, 3);
+
+    print("  toString():      %8.2f ms  peak memory: %10.1f KB\n", wholeNs / 1e6,
+          static_cast<double>(wholeBytes) / 1e3);
+    print("  ChunkedRenderer: %8.2f ms  peak memory: %10.1f KB\n", chunkedNs / 1e6,
+          static_cast<double>(chunkedBytes) / 1e3);
+    record("chunked_render/to_string", wholeNs / 1e6, "ms");
+    record("chunked_render/chunked", chunkedNs / 1e6, "ms");
+    record("chunked_render/to_string_memory", static_cast<double>(wholeBytes) / 1e3, "KB");
+    record("chunked_render/chunked_memory", static_cast<double>(chunkedBytes) / 1e3, "KB");
+
+    return checksum == expected;
+}
+
+bool mappedLoad()
+{
+    static const Textable::RowNumber rows = 200000;
+    static const Textable::ColumnNumber columns = 8;
+    static const char *path = "textable_bench.tbl";
+
+    print("Mapped load (%u x %u)\n", static_cast<unsigned>(rows), static_cast<unsigned>(columns));
+
+    // The cell texts as another process would have them, e.g. parsed from a file.
+    std::vector<std::vector<std::string>> cells(rows);
+    for (Textable::RowNumber r = 0; r < rows; ++r) {
+        for (Textable::ColumnNumber c = 0; c < columns; ++c) {
+            cells[r].push_back("cell " + std::to_string(r * columns + c));
+        }
+    }
+
+    auto rebuild = [&cells]() {
+        Textable textable;
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            textable.setRow(r, Textable::Align::Center, cells[r]);
+        }
+        return textable;
+    };
+    if (!MappedTextable::save(rebuild(), path)) {
+        print("  Failed to save the table\n");
+        return false;
+    }
+
+    std::string expected;
+    const auto rebuildLoadNs = measure([&]() { rebuild(); }, 3);
+    const auto rebuildNs = measure([&]() { expected = rebuild().toString(); }, 3);
+
+    const auto mappedLoadNs = measure([&]() {
+        MappedTextable mapped;
+        mapped.open(path);
+    }, 3);
+    std::string output;
+    const auto mappedNs = measure([&]() {
+        MappedTextable mapped;
+        mapped.open(path);
+        output = mapped.toString();
+    }, 3);
+    std::remove(path);
+
+    print("  setRow():       load: %8.2f ms  load and render: %8.2f ms\n", rebuildLoadNs / 1e6, rebuildNs / 1e6);
+    print("  MappedTextable: load: %8.2f ms  load and render: %8.2f ms  (%.1fx faster)\n", mappedLoadNs / 1e6,
+          mappedNs / 1e6, rebuildNs / mappedNs);
+    record("mapped_load/rebuild_load", rebuildLoadNs / 1e6, "ms");
+    record("mapped_load/rebuild_render", rebuildNs / 1e6, "ms");
+    record("mapped_load/mapped_load", mappedLoadNs / 1e6, "ms");
+    record("mapped_load/mapped_render", mappedNs / 1e6, "ms");
+
+    return output == expected;
+}
+
+bool cappedColumns()
+{
+    static const Textable::RowNumber rows = 100000;
+
+    print("Capped columns (%u rows, one 4 KB cell)\n", static_cast<unsigned>(rows));
+
+    std::string trace;
+    while (trace.size() < 4096) {
+        trace += "at frame " + std::to_string(trace.size()) + " in module::function(argument) ";
+    }
+
+    auto fill = [&trace](Textable &textable) {
+        for (Textable::RowNumber r = 0; r < rows; ++r) {
+            textable.appendRow(Textable::Align::Left, r, r == 10 ? trace : "message " + std::to_string(r));
+        }
+    };
+
+    auto run = [&](const char *name, Textable &textable) {
+        std::string output;
+        const auto ns = measure([&]() { output = textable.toString(); }, 3);
+        print("  %-10s %8.2f ms  output: %8.1f MB\n", name, ns / 1e6, static_cast<double>(output.size()) / 1e6);
+        record(std::string("capped_columns/") + name, ns / 1e6, "ms");
+        record(std::string("capped_columns/") + name + "_size", static_cast<double>(output.size()) / 1e6, "MB");
+        return output;
+    };
+
+    Textable plain;
+    fill(plain);
+    const auto plainOutput = run("unlimited", plain);
+
+    Textable::ColumnFormat format;
+    format.m_maxWidth = 80;
+    Textable truncated;
+    truncated.setColumnFormat(1, format);
+    fill(truncated);
+    const auto truncatedOutput = run("truncate", truncated);
+
+    format.m_overflow = Textable::ColumnFormat::Overflow::Wrap;
+    Textable wrapped;
+    wrapped.setColumnFormat(1, format);
+    fill(wrapped);
+    const auto wrappedOutput = run("wrap", wrapped);
+
+    // The capped tables take about a line per row and a line per 80 columns of the long cell.
+    const auto lineSize = truncatedOutput.find('\n') + 1;
+    return truncatedOutput.size() == (2 * rows + 1) * lineSize + 2 &&
+           wrappedOutput.size() < (2 * rows + 1 + trace.size() / 40) * lineSize &&
+           plainOutput.size() > 20 * wrappedOutput.size();
+}
+
+/// Prints the recorded results in the given machine readable \p format.
+void printResults(Format format)
+{
+    if (format == Format::Json) {
+        std::printf("[\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto &result = results[i];
+            std::printf("  { \"name\": \"%s\", \"value\": %.3f, \"unit\": \"%s\" }%s\n",
+                        result.m_name.c_str(), result.m_value, result.m_unit,
+                        i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    } else if (format == Format::Csv) {
+        std::printf("name,value,unit\n");
+        for (const auto &result : results) {
+            std::printf("%s,%.3f,%s\n", result.m_name.c_str(), result.m_value, result.m_unit);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    auto format = Format::Text;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--format=json") == 0) {
+            format = Format::Json;
+        } else if (std::strcmp(argv[i], "--format=csv") == 0) {
+            format = Format::Csv;
+        } else if (std::strcmp(argv[i], "--format=text") == 0) {
+            format = Format::Text;
+        } else {
+            std::fprintf(stderr, "Usage: %s [--format=text|json|csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (format != Format::Text) {
+        logFile = stderr;
+    }
+
+    bool ok = true;
+    ok = renderScaling() && ok;
+    ok = stringWidth() && ok;
+    ok = renderToString() && ok;
+    ok = parallelRender() && ok;
+    ok = numericIngestion() && ok;
+    ok = typedTable() && ok;
+    ok = shapesAndData() && ok;
+    ok = columnarStorage() && ok;
+    ok = bulkIngestion() && ok;
+    ok = sparseStorage() && ok;
+    ok = windowRender() && ok;
+    ok = renderCache() && ok;
+    ok = renderChanges() && ok;
+    ok = concurrentBuild() && ok;
+    ok = csvImport() && ok;
+    ok = requestTables() && ok;
+    ok = lazyCells() && ok;
+    ok = sortedViews() && ok;
+    ok = chunkedRender() && ok;
+    ok = mappedLoad() && ok;
+    ok = cappedColumns() && ok;
+
+    printResults(format);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "chunkedrenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+ChunkedRenderer::ChunkedRenderer(const Textable &table)
+    :
+        m_table(&table),
+        m_renderer(table.makeRenderer()),
+        m_lineCount(table.rowCount() == 0 ? 0 : 2 * table.rowCount() + 1)
+{
+}
+
+size_t ChunkedRenderer::next(char *buffer, size_t capacity)
+{
+    auto out = buffer;
+    const auto end = buffer + capacity;
+    while (m_line < m_lineCount && out < end) {
+        const auto space = static_cast<size_t>(end - out);
+
+        const char *line = nullptr;
+        size_t lineSize = 0;
+        if (m_line % 2 == 0) {
+            const auto &border = m_renderer.border();
+            line = border.data();
+            lineSize = border.size();
+        } else {
+            if (m_offset == 0) {
+                const auto &row = m_table->m_table[m_line / 2];
+                const auto size = m_renderer.rowSize(row);
+                if (size <= space) {
+                    out = m_renderer.writeRow(out, row);
+                    ++m_line;
+                    continue;
+                }
+                if (size > m_pending.size()) {
+                    m_pending.resize(size);
+                }
+                m_renderer.writeRow(&m_pending[0], row);
+                m_pendingSize = size;
+            }
+            line = m_pending.data();
+            lineSize = m_pendingSize;
+        }
+
+        const auto size = std::min(lineSize - m_offset, space);
+        std::memcpy(out, line + m_offset, size);
+        out += size;
+        m_offset += size;
+        if (m_offset == lineSize) {
+            m_offset = 0;
+            ++m_line;
+        }
+    }
+
+    const auto written = static_cast<size_t>(out - buffer);
+    m_renderedSize += written;
+    return written;
+}
+
+bool ChunkedRenderer::done() const
+{
+    return m_line == m_lineCount;
+}
+
+size_t ChunkedRenderer::renderedSize() const
+{
+    return m_renderedSize;
+}
+
+void ChunkedRenderer::restart()
+{
+    m_line = 0;
+    m_offset = 0;
+    m_renderedSize = 0;
+}
@@ -0,0 +1,95 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __CHUNKEDRENDERER_H__
+#define __CHUNKEDRENDERER_H__
+
+#include "renderer.h"
+#include "textable.h"
+
+#include <string>
+
+//! Implements the rendering of a table in chunks of the caller's size.
+/*!
+    Each `next()` call writes the following part of the rendered table into the given
+    buffer, and remembers where it stopped, even in the middle of a line. This allows
+    sending a large table to a non-blocking sink piece by piece, as the sink accepts
+    data, without rendering the whole table in memory first.
+
+    Lines that fit the remaining buffer space are written into the buffer directly.
+    A line that doesn't fit is rendered into an internal buffer once and handed out
+    over the following calls, so the memory use is bounded by the size of a single line.
+
+    The output is the same as the `Textable::toString()` one. The column widths are
+    calculated on construction, so the table should outlive the renderer, and should
+    not be modified while the table is rendered.
+
+    \example
+        ChunkedRenderer renderer(textable);
+        char buffer[4096];
+        while (!renderer.done()) {
+            const auto size = renderer.next(buffer, sizeof(buffer));
+            send(socket, buffer, size);
+        }
+*/
+class TEXTABLE_EXPORT ChunkedRenderer
+{
+public:
+    //! Constructs a renderer of the given \p table.
+    explicit ChunkedRenderer(const Textable &table);
+
+    //! Writes the next part of the rendered table into the \p buffer.
+    /*!
+        \returns Returns the number of written bytes, which is less than the \p capacity
+                 only for the last part. Returns zero once the whole table is rendered.
+    */
+    size_t next(char *buffer, size_t capacity);
+
+    //! Returns true if the whole table is rendered.
+    bool done() const;
+
+    //! Returns the number of bytes rendered so far.
+    size_t renderedSize() const;
+
+    //! Starts rendering the table from the beginning.
+    void restart();
+
+private:
+    const Textable *m_table;
+    Renderer m_renderer;
+
+    /// The number of lines, the borders and the rows, to render.
+    size_t m_lineCount;
+    /// The current line. Even lines are the borders, odd ones are the rows.
+    size_t m_line = 0;
+    /// The number of already rendered bytes of the current line.
+    size_t m_offset = 0;
+    size_t m_renderedSize = 0;
+
+    /// The current row line, if it doesn't fit the buffer.
+    std::string m_pending;
+    size_t m_pendingSize = 0;
+};
+
+#endif // !__CHUNKEDRENDERER_H__
@@ -0,0 +1,328 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "columnartextable.h"
+#include "parallel.h"
+#include "renderer.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+
+/// Don't compact small arenas.
+const size_t minCompactionSize = 4096;
+
+/// The size limit of a cell record. A byte is at most one column wide, so the width fits too.
+const size_t maxCellSize = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+const std::string &ColumnarTextable::cellText(const std::string &value, std::true_type)
+{
+    return value;
+}
+
+void ColumnarTextable::setCell(RowNumber row, ColumnNumber column, Align align, const char *data, size_t size)
+{
+    size = Unicode::codePointPrefix(data, size, maxCellSize);
+
+    if (column >= m_columns.size()) {
+        m_columns.resize(column + 1);
+        m_columnWidths.resize(column + 1);
+        m_cellCounts.resize(column + 1);
+    }
+    auto &cells = m_columns[column];
+    if (row >= cells.size()) {
+        cells.resize(row + 1, Cell());
+    }
+    m_rowCount = std::max(m_rowCount, row + 1);
+
+    auto &cell = cells[row];
+    const size_t oldWidth = cell.m_width;
+    m_garbage += cell.m_size;
+    m_extraSize -= cell.m_size - cell.m_width;
+
+    const auto width = Unicode::displayWidth(data, size);
+    cell.m_offset = m_arena.size();
+    cell.m_size = static_cast<uint32_t>(size);
+    cell.m_width = static_cast<uint32_t>(width);
+    cell.m_align = static_cast<uint32_t>(align);
+    if (!cell.m_set) {
+        cell.m_set = 1;
+        ++m_cellCounts[column];
+    }
+    m_arena.append(data, size);
+    m_extraSize += size - width;
+
+    updateColumnWidth(column, oldWidth, width);
+
+    if (m_garbage > minCompactionSize && m_garbage > m_arena.size() / 2) {
+        compact();
+    }
+}
+
+void ColumnarTextable::clearRow(RowNumber row, ColumnNumber column)
+{
+    m_rowCount = std::max(m_rowCount, row + 1);
+    for (auto c = column; c < m_columns.size(); ++c) {
+        auto &cells = m_columns[c];
+        if (row >= cells.size() || !cells[row].m_set) {
+            continue;
+        }
+        auto &cell = cells[row];
+        const size_t oldWidth = cell.m_width;
+        m_garbage += cell.m_size;
+        m_extraSize -= cell.m_size - cell.m_width;
+        cell = Cell();
+        --m_cellCounts[c];
+        updateColumnWidth(c, oldWidth, 0);
+    }
+
+    // The number of columns is the size of the longest row, as in Textable.
+    while (!m_cellCounts.empty() && m_cellCounts.back() == 0) {
+        m_columns.pop_back();
+        m_columnWidths.pop_back();
+        m_cellCounts.pop_back();
+    }
+}
+
+void ColumnarTextable::updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth)
+{
+    // The count of the widest cells is not maintained for empty columns.
+    auto &columnWidth = m_columnWidths[column];
+    if (newWidth > columnWidth.m_width) {
+        columnWidth.m_width = newWidth;
+        columnWidth.m_count = 1;
+        return;
+    }
+    if (newWidth == columnWidth.m_width && newWidth > 0) {
+        ++columnWidth.m_count;
+    }
+    if (oldWidth == columnWidth.m_width && oldWidth > 0 && --columnWidth.m_count == 0) {
+        // The widest cell got narrower, find the new widest ones.
+        columnWidth = {};
+        for (const auto &cell : m_columns[column]) {
+            if (cell.m_width > columnWidth.m_width) {
+                columnWidth.m_width = cell.m_width;
+                columnWidth.m_count = 1;
+            } else if (cell.m_width == columnWidth.m_width && cell.m_width > 0) {
+                ++columnWidth.m_count;
+            }
+        }
+    }
+}
+
+void ColumnarTextable::compact()
+{
+    // Keep the text in the rendering order.
+    std::string arena;
+    arena.reserve(m_arena.size() - m_garbage);
+    for (RowNumber r = 0; r < m_rowCount; ++r) {
+        for (auto &cells : m_columns) {
+            if (r < cells.size() && cells[r].m_size > 0) {
+                auto &cell = cells[r];
+                const auto offset = arena.size();
+                arena.append(m_arena, cell.m_offset, cell.m_size);
+                cell.m_offset = offset;
+            }
+        }
+    }
+    m_arena.swap(arena);
+    m_garbage = 0;
+}
+
+ColumnarTextable::RowNumber ColumnarTextable::rowCount() const
+{
+    return m_rowCount;
+}
+
+ColumnarTextable::ColumnNumber ColumnarTextable::columnCount() const
+{
+    return m_columns.size();
+}
+
+std::string ColumnarTextable::cellData(RowNumber row, ColumnNumber column) const
+{
+    if (column < m_columns.size() && row < m_columns[column].size()) {
+        const auto &cell = m_columns[column][row];
+        return m_arena.substr(cell.m_offset, cell.m_size);
+    }
+    return {};
+}
+
+size_t ColumnarTextable::memoryUsage() const
+{
+    auto size = m_arena.capacity() + m_columns.capacity() * sizeof(Column) +
+                m_columnWidths.capacity() * sizeof(ColumnWidth) + m_cellCounts.capacity() * sizeof(RowNumber);
+    for (const auto &cells : m_columns) {
+        size += cells.capacity() * sizeof(Cell);
+    }
+    return size;
+}
+
+std::vector<size_t> ColumnarTextable::columnWidths() const
+{
+    std::vector<size_t> widths(m_columnWidths.size());
+    for (ColumnNumber c = 0; c < m_columnWidths.size(); ++c) {
+        widths[c] = m_columnWidths[c].m_width;
+    }
+    return widths;
+}
+
+size_t ColumnarTextable::renderedSize() const
+{
+    if (m_rowCount == 0) {
+        return 0;
+    }
+
+    // All lines have the same size, except the bytes of multi-byte characters.
+    size_t lineSize = 1 + 1;
+    for (const auto &columnWidth : m_columnWidths) {
+        lineSize += columnWidth.m_width + Renderer::padding + 1;
+    }
+    return lineSize * (2 * m_rowCount + 1) + m_extraSize;
+}
+
+size_t ColumnarTextable::rowSize(RowNumber row, size_t lineSize) const
+{
+    auto size = lineSize;
+    for (const auto &cells : m_columns) {
+        if (row < cells.size()) {
+            size += cells[row].m_size - cells[row].m_width;
+        }
+    }
+    return size;
+}
+
+char *ColumnarTextable::writeRow(char *out, const Renderer &renderer, RowNumber row) const
+{
+    *out++ = '|';
+    for (ColumnNumber c = 0; c < m_columns.size(); ++c) {
+        const auto &cells = m_columns[c];
+        if (row < cells.size()) {
+            const auto &cell = cells[row];
+            out = renderer.writeCell(out, c, m_arena.data() + cell.m_offset, cell.m_size, cell.m_width,
+                                     static_cast<Align>(cell.m_align));
+        } else {
+            out = renderer.writeEmptyCell(out, c);
+        }
+        *out++ = '|';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+size_t ColumnarTextable::renderTo(char *buffer, size_t capacity) const
+{
+    return renderTo(buffer, capacity, 1U);
+}
+
+size_t ColumnarTextable::renderTo(char *buffer, size_t capacity, unsigned threadCount) const
+{
+    const auto size = renderedSize();
+    if (size == 0 || size > capacity) {
+        return size;
+    }
+
+    // Not worth a thread below this number of rows.
+    static const size_t minRowsPerThread = 4096;
+
+    const Renderer renderer(columnWidths());
+    const auto lineSize = renderer.lineSize();
+    const auto slices = parallel::sliceCount(m_rowCount, parallel::threadCount(threadCount),
+                                             minRowsPerThread);
+
+    // Find the size of each slice of rows, then the slices offsets.
+    std::vector<size_t> offsets(slices + 1, 0);
+    offsets[0] = lineSize;
+    if (slices > 1) {
+        parallel::forEachSlice(m_rowCount, slices, [&](unsigned slice, size_t begin, size_t end) {
+            size_t sliceSize = 0;
+            for (auto r = begin; r < end; ++r) {
+                sliceSize += rowSize(r, lineSize) + lineSize;
+            }
+            offsets[slice + 1] = sliceSize;
+        });
+        for (unsigned slice = 0; slice < slices; ++slice) {
+            offsets[slice + 1] += offsets[slice];
+        }
+    } else {
+        offsets[1] = size;
+    }
+    assert(offsets.back() == size);
+
+    renderer.writeBorder(buffer);
+    parallel::forEachSlice(m_rowCount, slices, [&](unsigned slice, size_t begin, size_t end) {
+        auto out = buffer + offsets[slice];
+        for (auto r = begin; r < end; ++r) {
+            out = writeRow(out, renderer, r);
+            out = renderer.writeBorder(out);
+        }
+        assert(out == buffer + offsets[slice + 1]);
+    });
+
+    return size;
+}
+
+std::string ColumnarTextable::toString() const
+{
+    return toString(1U);
+}
+
+std::string ColumnarTextable::toString(unsigned threadCount) const
+{
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size(), threadCount);
+    }
+    return result;
+}
+
+std::ostream &operator<<(std::ostream &os, const ColumnarTextable &table)
+{
+    if (table.m_rowCount == 0) {
+        return os;
+    }
+
+    const Renderer renderer(table.columnWidths());
+    const auto &border = renderer.border();
+
+    // A single buffer for all rows.
+    std::string buffer;
+
+    os.write(border.data(), border.size());
+    for (ColumnarTextable::RowNumber r = 0; r < table.m_rowCount; ++r) {
+        buffer.resize(table.rowSize(r, renderer.lineSize()));
+        const auto end = table.writeRow(&buffer[0], renderer, r);
+        assert(end == buffer.data() + buffer.size());
+        (void)end;
+        os.write(buffer.data(), buffer.size());
+        os.write(border.data(), border.size());
+    }
+    return os;
+}
@@ -0,0 +1,234 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __COLUMNARTEXTABLE_H__
+#define __COLUMNARTEXTABLE_H__
+
+#include "textable.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class Renderer;
+
+//! Implements a text table with a compact, columnar cell storage.
+/*!
+    The text of all cells is packed into a single growable buffer (the arena) and
+    every cell is a small fixed size record of the text offset, size, display width and
+    alignment. The records of each column are stored contiguously. Thus, the table
+    makes one allocation per column rather than one per row and per long cell, and the
+    rendering reads the cells from a few contiguous arrays.
+
+    Overwritten cells leave their old text in the arena. The arena is compacted once
+    the unused text takes more than a half of it.
+
+    A cell holds up to 4 GiB - 1 bytes of text. Longer texts are cut to the longest
+    prefix that fits, without splitting a character.
+
+    The output format is the same as the `Textable` one.
+*/
+class TEXTABLE_EXPORT ColumnarTextable
+{
+public:
+    using Align        = Textable::Align;
+    using RowNumber    = Textable::RowNumber;
+    using ColumnNumber = Textable::ColumnNumber;
+
+    //! Sets a value to the cell referred by the given \p row and \p column.
+    /*!
+        The value is converted to the text as `Textable::setCell()` does.
+    */
+    template<typename T>
+    void setCell(RowNumber row, ColumnNumber column, Align align, T && value);
+
+    //! Sets the text of the given \p size to the cell referred by the given \p row and \p column.
+    void setCell(RowNumber row, ColumnNumber column, Align align, const char *data, size_t size);
+
+    //! Sets the values of the \p rowData container to the given \p row, starting from the first column.
+    /*!
+        The row is replaced as a whole, as `Textable::setRow()` does: the cells past the
+        end of the container are cleared.
+    */
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setRow(RowNumber row, Align align, T && rowData);
+
+    //! Sets the values to the given \p row, starting from the first column.
+    template<typename Value, typename... Ts>
+    void setRow(RowNumber row, Align align, Value && value, Ts &&... restValues);
+
+    //! Sets the values of the \p columnData container to the given \p column, starting from the first row.
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setColumn(ColumnNumber column, Align align, T && columnData);
+
+    //! Returns the number of rows of the table.
+    RowNumber rowCount() const;
+
+    //! Returns the number of columns of the table.
+    ColumnNumber columnCount() const;
+
+    //! Returns the text of the cell referred by the given \p row and \p column.
+    /*!
+        Returns an empty string if the cell is not set.
+    */
+    std::string cellData(RowNumber row, ColumnNumber column) const;
+
+    //! Returns the number of bytes allocated for the table data.
+    size_t memoryUsage() const;
+
+    //! Returns the content widths of the columns, excluding the cell padding.
+    std::vector<size_t> columnWidths() const;
+
+    //! Returns the size of the rendered table in bytes.
+    size_t renderedSize() const;
+
+    //! Renders the table into the \p buffer of the given \p capacity.
+    /*!
+        \returns Returns the size of the rendered table. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Renders the table into the \p buffer using up to \p threadCount threads.
+    /*!
+        Zero \p threadCount means the number of the hardware threads.
+    */
+    size_t renderTo(char *buffer, size_t capacity, unsigned threadCount) const;
+
+    //! Returns the string representation of the table.
+    std::string toString() const;
+
+    //! Returns the string representation of the table rendered with up to \p threadCount threads.
+    std::string toString(unsigned threadCount) const;
+
+    friend TEXTABLE_EXPORT std::ostream &operator<<(std::ostream &os, const ColumnarTextable &table);
+
+private:
+    /// A cell record. The records of the cells that were never set are zeros.
+    struct Cell
+    {
+        uint64_t m_offset : 61;
+        uint64_t m_align : 2;
+        uint64_t m_set : 1;
+        uint32_t m_size;
+        uint32_t m_width;
+    };
+
+    using Column = std::vector<Cell>;
+
+    /// Holds the width of a column.
+    struct ColumnWidth
+    {
+        size_t m_width = 0;     ///< The widest cell width.
+        RowNumber m_count = 0;  ///< The number of cells that have the widest width.
+    };
+
+    /// Converts the value to the cell text.
+    template<typename T>
+    static std::string cellText(T && value, std::false_type);
+
+    /// Returns the string values as is.
+    static const std::string &cellText(const std::string &value, std::true_type);
+
+    /// Updates the \p column width after a cell of the column changed its width.
+    void updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth);
+
+    /// Clears the cells of the \p row from the given \p column on, and makes sure the row exists.
+    /*!
+        The trailing columns that are left without cells are removed.
+    */
+    void clearRow(RowNumber row, ColumnNumber column);
+
+    /// Writes the \p row line into \p out and returns the end of the written data.
+    char *writeRow(char *out, const Renderer &renderer, RowNumber row) const;
+
+    /// Rewrites the arena without the text of the overwritten cells.
+    void compact();
+
+    /// Returns the size of the rendered \p row line in bytes.
+    size_t rowSize(RowNumber row, size_t lineSize) const;
+
+    std::string m_arena;
+
+    /// The size of the text in the arena, that is not referred by any cell.
+    size_t m_garbage = 0;
+
+    /// The number of bytes all cells take in excess of their display width.
+    size_t m_extraSize = 0;
+
+    std::vector<Column> m_columns;
+    std::vector<ColumnWidth> m_columnWidths;
+
+    /// The number of the set cells of each column.
+    std::vector<RowNumber> m_cellCounts;
+    RowNumber m_rowCount = 0;
+};
+
+template<typename T>
+std::string ColumnarTextable::cellText(T && value, std::false_type)
+{
+    return Textable::valueToString(std::forward<T>(value));
+}
+
+template<typename T>
+void ColumnarTextable::setCell(RowNumber row, ColumnNumber column, Align align, T && value)
+{
+    using IsString = std::is_same<typename std::decay<T>::type, std::string>;
+    const auto &text = cellText(std::forward<T>(value), IsString{});
+    setCell(row, column, align, text.data(), text.size());
+}
+
+template<typename T, typename U, typename>
+void ColumnarTextable::setRow(RowNumber row, Align align, T && rowData)
+{
+    ColumnNumber column = 0;
+    for (const auto &value : rowData) {
+        setCell(row, column++, align, value);
+    }
+    clearRow(row, column);
+}
+
+template<typename Value, typename... Ts>
+void ColumnarTextable::setRow(RowNumber row, Align align, Value && value, Ts &&... restValues)
+{
+    ColumnNumber column = 0;
+    setCell(row, column++, align, std::forward<Value>(value));
+    const int expand[] = { 0, (setCell(row, column++, align, std::forward<Ts>(restValues)), 0)... };
+    (void)expand;
+}
+
+template<typename T, typename U, typename>
+void ColumnarTextable::setColumn(ColumnNumber column, Align align, T && columnData)
+{
+    RowNumber row = 0;
+    for (const auto &value : columnData) {
+        setCell(row++, column, align, value);
+    }
+}
+
+#endif // !__COLUMNARTEXTABLE_H__
@@ -0,0 +1,246 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "csvreader.h"
+#include "mappedfile.h"
+#include "parallel.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define TEXTABLE_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace
+{
+
+/// Returns the first delimiter, quote or line feed of [\p data, \p end), or \p end.
+const char *findSpecialScalar(const char *data, const char *end, char delimiter, char quote)
+{
+    static const std::uint64_t lowBits = 0x0101010101010101ULL;
+    static const std::uint64_t highBits = 0x8080808080808080ULL;
+
+    const auto delimiters = lowBits * static_cast<unsigned char>(delimiter);
+    const auto quotes = lowBits * static_cast<unsigned char>(quote);
+    const auto lineFeeds = lowBits * static_cast<unsigned char>('\n');
+
+    // A byte of the chunk equals to the character if the corresponding byte of the XOR is zero.
+    auto hasZero = [](std::uint64_t value) {
+        return ((value - lowBits) & ~value & highBits) != 0;
+    };
+
+    for (; end - data >= 8; data += 8) {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, data, sizeof(chunk));
+        if (hasZero(chunk ^ delimiters) || hasZero(chunk ^ quotes) || hasZero(chunk ^ lineFeeds)) {
+            break;
+        }
+    }
+    while (data < end && *data != delimiter && *data != quote && *data != '\n') {
+        ++data;
+    }
+    return data;
+}
+
+#if defined(TEXTABLE_SSE2)
+/// Returns the number of trailing zero bits of a non-zero \p value.
+inline unsigned trailingZeros(std::uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+}
+
+const char *findSpecial(const char *data, const char *end, char delimiter, char quote)
+{
+    const auto delimiters = _mm_set1_epi8(delimiter);
+    const auto quotes = _mm_set1_epi8(quote);
+    const auto lineFeeds = _mm_set1_epi8('\n');
+
+    for (; end - data >= 16; data += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+        const auto matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, delimiters),
+                                                       _mm_cmpeq_epi8(chunk, quotes)),
+                                          _mm_cmpeq_epi8(chunk, lineFeeds));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(matches));
+        if (mask != 0) {
+            return data + trailingZeros(mask);
+        }
+    }
+    return findSpecialScalar(data, end, delimiter, quote);
+}
+#else
+const char *findSpecial(const char *data, const char *end, char delimiter, char quote)
+{
+    return findSpecialScalar(data, end, delimiter, quote);
+}
+#endif
+
+/// Returns the number of \p quote characters of the given data.
+size_t countQuotes(const char *data, size_t size, char quote)
+{
+    size_t count = 0;
+    for (auto end = data + size; (data = static_cast<const char *>(std::memchr(data, quote, end - data))); ++data) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+CsvReader::CsvReader()
+    :
+        CsvReader(Options{})
+{}
+
+CsvReader::CsvReader(Options options)
+    :
+        m_options(std::move(options))
+{}
+
+bool CsvReader::read(const std::string &path, Textable &table) const
+{
+    MappedFile file(path, true);
+    if (!file.good()) {
+        return false;
+    }
+    parse(file.data(), file.size(), table);
+    return true;
+}
+
+void CsvReader::parse(const char *data, size_t size, Textable &table) const
+{
+    const auto slices = parallel::sliceCount(size, parallel::threadCount(m_options.m_threadCount),
+                                             m_options.m_chunkSize);
+    const auto dataEnd = data + size;
+
+    // A line feed ends a record only outside of the quoted parts, i.e. after an even
+    // number of quotes. Count the quotes of each slice to know the state at its start.
+    std::vector<size_t> quotes(slices);
+    parallel::forEachSlice(size, slices, [&](unsigned slice, size_t begin, size_t end) {
+        quotes[slice] = countQuotes(data + begin, end - begin, m_options.m_quote);
+    });
+
+    // Each slice parses the records that start within it.
+    std::vector<Textable> parts(slices);
+    parallel::forEachSlice(size, slices, [&](unsigned slice, size_t begin, size_t end) {
+        size_t quoteCount = 0;
+        for (unsigned s = 0; s < slice; ++s) {
+            quoteCount += quotes[s];
+        }
+
+        // Skip the rest of the record that started in the previous slice, if any.
+        auto start = data + begin;
+        auto quoted = quoteCount % 2 != 0;
+        if (begin > 0 && (quoted || start[-1] != '\n')) {
+            while (start < dataEnd && (quoted || *start != '\n')) {
+                quoted ^= *start == m_options.m_quote;
+                ++start;
+            }
+            if (start < dataEnd) {
+                ++start;
+            }
+        }
+        if (start < data + end) {
+            parseRecords(start, data + end, dataEnd, parts[slice]);
+        }
+    });
+
+    for (auto &part : parts) {
+        table.splice(std::move(part));
+    }
+}
+
+void CsvReader::parseRecords(const char *begin, const char *end, const char *dataEnd, Textable &table) const
+{
+    std::string field;
+    Textable::ColumnNumber columnCount = 0;
+    while (begin < end) {
+        Textable::Row row;
+        row.reserve(columnCount);
+
+        char terminator = '\n';
+        do {
+            begin = parseField(begin, dataEnd, field, terminator);
+            row.emplace_back(std::move(field), m_options.m_align);
+        } while (terminator != '\n');
+
+        columnCount = row.size();
+        table.appendRow(std::move(row));
+    }
+}
+
+const char *CsvReader::parseField(const char *data, const char *dataEnd, std::string &field, char &terminator) const
+{
+    field.clear();
+    for (;;) {
+        const auto stop = findSpecial(data, dataEnd, m_options.m_delimiter, m_options.m_quote);
+        field.append(data, stop);
+        if (stop == dataEnd) {
+            terminator = '\n';
+            if (stop > data && stop[-1] == '\r') {
+                field.pop_back();
+            }
+            return dataEnd;
+        }
+        if (*stop != m_options.m_quote) {
+            terminator = *stop;
+            if (*stop == '\n' && stop > data && stop[-1] == '\r') {
+                field.pop_back();
+            }
+            return stop + 1;
+        }
+
+        // The quoted part ends with a quote that is not followed by another one.
+        data = stop + 1;
+        for (;;) {
+            const auto quote = static_cast<const char *>(std::memchr(data, m_options.m_quote, dataEnd - data));
+            if (!quote) {
+                // The quoted part is not closed.
+                field.append(data, dataEnd);
+                terminator = '\n';
+                return dataEnd;
+            }
+            field.append(data, quote);
+            data = quote + 1;
+            if (data == dataEnd || *data != m_options.m_quote) {
+                break;
+            }
+            field += m_options.m_quote;
+            ++data;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __CSVREADER_H__
+#define __CSVREADER_H__
+
+#include "textable.h"
+
+#include <string>
+
+//! Implements the import of CSV, TSV and other delimiter separated files into tables.
+/*!
+    Files are memory mapped and parsed in place. The input is split into chunks that are
+    parsed by multiple threads, each into its own partial table, and the partial tables
+    are spliced into the target table in order. The row and field boundaries are found
+    with SIMD instructions (SSE2 where available, with a scalar fallback), and the cell
+    display widths are computed by the parsing threads.
+
+    The format follows RFC 4180:
+    - records end with LF or CRLF, the line break of the last record is optional;
+    - fields are separated by the delimiter;
+    - a field can be quoted, so that it may contain delimiters, quotes and line breaks.
+      Two quotes inside a quoted part stand for a literal quote.
+
+    A quote starts a quoted part anywhere in a field, so that the quotes are always
+    balanced, and the input can be split into chunks by the quote parity.
+
+    \example
+        CsvReader::Options options;
+        options.m_delimiter = '\t';
+        Textable textable;
+        if (!CsvReader(options).read("export.tsv", textable)) {
+            // The file can't be read.
+        }
+*/
+class TEXTABLE_EXPORT CsvReader
+{
+public:
+    /// Defines the reader options.
+    struct Options
+    {
+        /// The field delimiter, e.g. ',' for CSV or '\t' for TSV.
+        char m_delimiter = ',';
+
+        /// The quote character.
+        char m_quote = '"';
+
+        /// The alignment of the cells.
+        Textable::Align m_align = Textable::Align::Left;
+
+        /// The number of threads to use, zero means the number of hardware threads.
+        unsigned m_threadCount = 0;
+
+        /// The minimal number of bytes per thread, so that small inputs are not split.
+        size_t m_chunkSize = 1 << 20;
+    };
+
+    //! Constructs a CSV reader with the default options.
+    CsvReader();
+
+    //! Constructs a reader with the given \p options.
+    explicit CsvReader(Options options);
+
+    //! Reads the file of the given \p path and appends its records to the \p table.
+    /*!
+        The file is memory mapped, not read into a buffer.
+        \returns Returns false if the file can't be opened or mapped. The table is not
+                 modified in that case.
+    */
+    bool read(const std::string &path, Textable &table) const;
+
+    //! Parses the \p data of the given \p size and appends its records to the \p table.
+    void parse(const char *data, size_t size, Textable &table) const;
+
+private:
+    /// Parses the records that start in [\p begin, \p end) of the data ending at \p dataEnd.
+    void parseRecords(const char *begin, const char *end, const char *dataEnd, Textable &table) const;
+
+    /// Parses a field that starts at \p data into the \p field string.
+    /*!
+        \param terminator Receives the delimiter or the line feed that ended the field.
+        \returns Returns the position after the terminator.
+    */
+    const char *parseField(const char *data, const char *dataEnd, std::string &field, char &terminator) const;
+
+    Options m_options;
+};
+
+#endif // !__CSVREADER_H__
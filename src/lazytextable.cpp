@@ -0,0 +1,466 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "lazytextable.h"
+#include "parallel.h"
+#include "renderer.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+
+/// Don't compact small arenas.
+const size_t minCompactionSize = 4096;
+
+/// The size limit of a cell record. A byte is at most one column wide, so the width fits too.
+const size_t maxCellSize = std::numeric_limits<uint32_t>::max();
+
+/// Returns the size of the longest prefix of the text that fits a cell record.
+size_t fitText(const char *data, size_t size, size_t &width)
+{
+    size = Unicode::codePointPrefix(data, size, maxCellSize);
+    width = Unicode::displayWidth(data, size);
+    return size;
+}
+
+} // namespace
+
+LazyTextable::LazyTextable(const LazyTextable &other)
+{
+    *this = other;
+}
+
+LazyTextable &LazyTextable::operator=(const LazyTextable &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    std::lock(m_mutex, other.m_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex, std::adopt_lock);
+    std::lock_guard<std::mutex> otherLock(other.m_mutex, std::adopt_lock);
+
+    m_arena = other.m_arena;
+    m_columns = other.m_columns;
+    m_columnWidths = other.m_columnWidths;
+    m_formatters = other.m_formatters;
+    m_garbage = other.m_garbage;
+    m_extraSize = other.m_extraSize;
+    m_pendingCount = other.m_pendingCount;
+    m_rowCount = other.m_rowCount;
+    return *this;
+}
+
+LazyTextable::Cell &LazyTextable::resetCell(RowNumber row, ColumnNumber column, Align align, Kind kind)
+{
+    static_assert(sizeof(Cell) == 24, "Unexpected cell record size");
+
+    if (column >= m_columns.size()) {
+        m_columns.resize(column + 1);
+        m_columnWidths.resize(column + 1);
+    }
+    auto &cells = m_columns[column];
+    if (row >= cells.size()) {
+        cells.resize(row + 1);
+    }
+    m_rowCount = std::max(m_rowCount, row + 1);
+
+    auto &cell = cells[row];
+    const auto oldCell = cell;
+    cell = Cell();
+    if (oldCell.m_formatted) {
+        m_garbage += oldCell.m_size;
+        m_extraSize -= oldCell.m_size - oldCell.m_width;
+        updateColumnWidth(column, oldCell.m_width, 0);
+    } else {
+        --m_pendingCount;
+        if (static_cast<Kind>(oldCell.m_kind) == Kind::Deferred) {
+            m_formatters[oldCell.m_value.m_formatter] = nullptr;
+        }
+    }
+
+    cell.m_kind = static_cast<uint32_t>(kind);
+    cell.m_align = static_cast<uint32_t>(align);
+    if (kind != Kind::Text) {
+        cell.m_formatted = 0;
+        ++m_pendingCount;
+    }
+    return cell;
+}
+
+void LazyTextable::setCell(RowNumber row, ColumnNumber column, Align align, const char *data, size_t size)
+{
+    size_t width = 0;
+    size = fitText(data, size, width);
+
+    auto &cell = resetCell(row, column, align, Kind::Text);
+    cell.m_offset = m_arena.size();
+    cell.m_size = static_cast<uint32_t>(size);
+    cell.m_width = static_cast<uint32_t>(width);
+    m_arena.append(data, size);
+    m_extraSize += size - width;
+    updateColumnWidth(column, 0, width);
+
+    if (m_garbage > minCompactionSize && m_garbage > m_arena.size() / 2) {
+        compact();
+    }
+}
+
+void LazyTextable::setDeferredCell(RowNumber row, ColumnNumber column, Align align, Formatter formatter)
+{
+    auto &cell = resetCell(row, column, align, Kind::Deferred);
+    cell.m_value.m_formatter = m_formatters.size();
+    m_formatters.push_back(std::move(formatter));
+}
+
+void LazyTextable::setValue(RowNumber row, ColumnNumber column, Align align, long long value)
+{
+    resetCell(row, column, align, Kind::Signed).m_value.m_signed = value;
+}
+
+void LazyTextable::setValue(RowNumber row, ColumnNumber column, Align align, unsigned long long value)
+{
+    resetCell(row, column, align, Kind::Unsigned).m_value.m_unsigned = value;
+}
+
+void LazyTextable::setValue(RowNumber row, ColumnNumber column, Align align, double value)
+{
+    resetCell(row, column, align, Kind::Floating).m_value.m_floating = value;
+}
+
+void LazyTextable::setValue(RowNumber row, ColumnNumber column, Align align, bool value)
+{
+    resetCell(row, column, align, Kind::Bool).m_value.m_unsigned = value ? 1 : 0;
+}
+
+void LazyTextable::setValue(RowNumber row, ColumnNumber column, Align align, char value)
+{
+    resetCell(row, column, align, Kind::Char).m_value.m_unsigned = static_cast<unsigned char>(value);
+}
+
+void LazyTextable::formatCell(Cell &cell, ColumnNumber column) const
+{
+    assert(!cell.m_formatted);
+
+    std::string text;
+    switch (static_cast<Kind>(cell.m_kind)) {
+    case Kind::Signed:
+        text = Textable::signedToString(cell.m_value.m_signed);
+        break;
+    case Kind::Unsigned:
+        text = Textable::unsignedToString(cell.m_value.m_unsigned);
+        break;
+    case Kind::Floating:
+        text = Textable::floatingToString(cell.m_value.m_floating);
+        break;
+    case Kind::Bool:
+        text = cell.m_value.m_unsigned ? "true" : "false";
+        break;
+    case Kind::Char:
+        text.assign(1, static_cast<char>(cell.m_value.m_unsigned));
+        break;
+    case Kind::Deferred: {
+        auto &formatter = m_formatters[cell.m_value.m_formatter];
+        if (formatter) {
+            text = formatter();
+        }
+        // Release the captured state.
+        formatter = nullptr;
+        break;
+    }
+    case Kind::Empty:
+    case Kind::Text:
+        break;
+    }
+
+    size_t width = 0;
+    text.resize(fitText(text.data(), text.size(), width));
+    cell.m_offset = m_arena.size();
+    cell.m_size = static_cast<uint32_t>(text.size());
+    cell.m_width = static_cast<uint32_t>(width);
+    cell.m_formatted = 1;
+    m_arena.append(text);
+    m_extraSize += text.size() - width;
+    --m_pendingCount;
+    updateColumnWidth(column, 0, width);
+}
+
+void LazyTextable::formatPending() const
+{
+    if (m_pendingCount == 0) {
+        return;
+    }
+
+    // Format in the rendering order, so that the text of a row is close together.
+    for (RowNumber r = 0; r < m_rowCount && m_pendingCount > 0; ++r) {
+        for (ColumnNumber c = 0; c < m_columns.size(); ++c) {
+            auto &cells = m_columns[c];
+            if (r < cells.size() && !cells[r].m_formatted) {
+                formatCell(cells[r], c);
+            }
+        }
+    }
+
+    // All formatters have been called.
+    m_formatters.clear();
+}
+
+void LazyTextable::updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth) const
+{
+    if (oldWidth == newWidth) {
+        return;
+    }
+
+    // The count of the widest cells is not maintained for empty columns.
+    auto &columnWidth = m_columnWidths[column];
+    if (newWidth > columnWidth.m_width) {
+        columnWidth.m_width = newWidth;
+        columnWidth.m_count = 1;
+        return;
+    }
+    if (newWidth == columnWidth.m_width && newWidth > 0) {
+        ++columnWidth.m_count;
+    }
+    if (oldWidth == columnWidth.m_width && oldWidth > 0 && --columnWidth.m_count == 0) {
+        // The widest cell got narrower, find the new widest ones among the formatted cells.
+        columnWidth = {};
+        for (const auto &cell : m_columns[column]) {
+            if (!cell.m_formatted) {
+                continue;
+            }
+            if (cell.m_width > columnWidth.m_width) {
+                columnWidth.m_width = cell.m_width;
+                columnWidth.m_count = 1;
+            } else if (cell.m_width == columnWidth.m_width && cell.m_width > 0) {
+                ++columnWidth.m_count;
+            }
+        }
+    }
+}
+
+void LazyTextable::compact() const
+{
+    // Keep the text in the rendering order.
+    std::string arena;
+    arena.reserve(m_arena.size() - m_garbage);
+    for (RowNumber r = 0; r < m_rowCount; ++r) {
+        for (auto &cells : m_columns) {
+            if (r < cells.size() && cells[r].m_formatted && cells[r].m_size > 0) {
+                auto &cell = cells[r];
+                const auto offset = arena.size();
+                arena.append(m_arena, cell.m_offset, cell.m_size);
+                cell.m_offset = offset;
+            }
+        }
+    }
+    m_arena.swap(arena);
+    m_garbage = 0;
+}
+
+LazyTextable::RowNumber LazyTextable::rowCount() const
+{
+    return m_rowCount;
+}
+
+LazyTextable::ColumnNumber LazyTextable::columnCount() const
+{
+    return m_columns.size();
+}
+
+size_t LazyTextable::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingCount;
+}
+
+std::string LazyTextable::cellData(RowNumber row, ColumnNumber column) const
+{
+    if (column >= m_columns.size() || row >= m_columns[column].size()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &cell = m_columns[column][row];
+    if (!cell.m_formatted) {
+        formatCell(cell, column);
+    }
+    return m_arena.substr(cell.m_offset, cell.m_size);
+}
+
+size_t LazyTextable::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto size = m_arena.capacity() + m_columns.capacity() * sizeof(Column) +
+                m_columnWidths.capacity() * sizeof(ColumnWidth) +
+                m_formatters.capacity() * sizeof(Formatter);
+    for (const auto &cells : m_columns) {
+        size += cells.capacity() * sizeof(Cell);
+    }
+    return size;
+}
+
+std::vector<size_t> LazyTextable::columnWidths() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    formatPending();
+
+    std::vector<size_t> widths(m_columnWidths.size());
+    for (ColumnNumber c = 0; c < m_columnWidths.size(); ++c) {
+        widths[c] = m_columnWidths[c].m_width;
+    }
+    return widths;
+}
+
+size_t LazyTextable::renderedSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    formatPending();
+    return formattedSize();
+}
+
+size_t LazyTextable::formattedSize() const
+{
+    if (m_rowCount == 0) {
+        return 0;
+    }
+
+    // All lines have the same size, except the bytes of multi-byte characters.
+    size_t lineSize = 1 + 1;
+    for (const auto &columnWidth : m_columnWidths) {
+        lineSize += columnWidth.m_width + Renderer::padding + 1;
+    }
+    return lineSize * (2 * m_rowCount + 1) + m_extraSize;
+}
+
+size_t LazyTextable::rowSize(RowNumber row, size_t lineSize) const
+{
+    auto size = lineSize;
+    for (const auto &cells : m_columns) {
+        if (row < cells.size()) {
+            size += cells[row].m_size - cells[row].m_width;
+        }
+    }
+    return size;
+}
+
+char *LazyTextable::writeRow(char *out, const Renderer &renderer, RowNumber row) const
+{
+    *out++ = '|';
+    for (ColumnNumber c = 0; c < m_columns.size(); ++c) {
+        const auto &cells = m_columns[c];
+        if (row < cells.size()) {
+            const auto &cell = cells[row];
+            out = renderer.writeCell(out, c, m_arena.data() + cell.m_offset, cell.m_size, cell.m_width,
+                                     static_cast<Align>(cell.m_align));
+        } else {
+            out = renderer.writeEmptyCell(out, c);
+        }
+        *out++ = '|';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+size_t LazyTextable::renderTo(char *buffer, size_t capacity) const
+{
+    return renderTo(buffer, capacity, 1U);
+}
+
+size_t LazyTextable::renderTo(char *buffer, size_t capacity, unsigned threadCount) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    formatPending();
+
+    const auto size = formattedSize();
+    if (size == 0 || size > capacity) {
+        return size;
+    }
+
+    // Not worth a thread below this number of rows.
+    static const size_t minRowsPerThread = 4096;
+
+    std::vector<size_t> widths(m_columnWidths.size());
+    for (ColumnNumber c = 0; c < m_columnWidths.size(); ++c) {
+        widths[c] = m_columnWidths[c].m_width;
+    }
+    const Renderer renderer(std::move(widths));
+    const auto lineSize = renderer.lineSize();
+    const auto slices = parallel::sliceCount(m_rowCount, parallel::threadCount(threadCount),
+                                             minRowsPerThread);
+
+    // Find the size of each slice of rows, then the slices offsets.
+    std::vector<size_t> offsets(slices + 1, 0);
+    offsets[0] = lineSize;
+    if (slices > 1) {
+        parallel::forEachSlice(m_rowCount, slices, [&](unsigned slice, size_t begin, size_t end) {
+            size_t sliceSize = 0;
+            for (auto r = begin; r < end; ++r) {
+                sliceSize += rowSize(r, lineSize) + lineSize;
+            }
+            offsets[slice + 1] = sliceSize;
+        });
+        for (unsigned slice = 0; slice < slices; ++slice) {
+            offsets[slice + 1] += offsets[slice];
+        }
+    } else {
+        offsets[1] = size;
+    }
+    assert(offsets.back() == size);
+
+    renderer.writeBorder(buffer);
+    parallel::forEachSlice(m_rowCount, slices, [&](unsigned slice, size_t begin, size_t end) {
+        auto out = buffer + offsets[slice];
+        for (auto r = begin; r < end; ++r) {
+            out = writeRow(out, renderer, r);
+            out = renderer.writeBorder(out);
+        }
+        assert(out == buffer + offsets[slice + 1]);
+    });
+
+    return size;
+}
+
+std::string LazyTextable::toString() const
+{
+    return toString(1U);
+}
+
+std::string LazyTextable::toString(unsigned threadCount) const
+{
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size(), threadCount);
+    }
+    return result;
+}
+
+std::ostream &operator<<(std::ostream &os, const LazyTextable &table)
+{
+    const auto string = table.toString();
+    return os.write(string.data(), string.size());
+}
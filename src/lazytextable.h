@@ -0,0 +1,304 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __LAZYTEXTABLE_H__
+#define __LAZYTEXTABLE_H__
+
+#include "textable.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class Renderer;
+
+//! Implements a text table that converts the cell values to text only when needed.
+/*!
+    Integers, floating point numbers, booleans and characters are stored in their typed
+    form in small fixed size cell records, so that populating the table neither converts
+    nor allocates anything per cell. The values are converted to text the first time the
+    text is needed - by `cellData()`, the column widths or the rendering - and the text is
+    cached in a single buffer (the arena) for the following calls. The text of user types
+    can be deferred too, with a formatter function.
+
+    Strings are stored in the arena right away, as they are their own text. Other types
+    are converted to text immediately, as `Textable::setCell()` does.
+
+    The text is the same as the one of `Textable`, and so is the output format.
+    A cell holds up to 4 GiB - 1 bytes of text. Longer texts are cut to the longest
+    prefix that fits, without splitting a character.
+    The const functions can be called concurrently, the conversions are serialized.
+*/
+class TEXTABLE_EXPORT LazyTextable
+{
+public:
+    using Align        = Textable::Align;
+    using RowNumber    = Textable::RowNumber;
+    using ColumnNumber = Textable::ColumnNumber;
+
+    /// Makes the text of a deferred cell.
+    using Formatter = std::function<std::string()>;
+
+    LazyTextable() = default;
+    LazyTextable(const LazyTextable &other);
+    LazyTextable &operator=(const LazyTextable &other);
+
+    //! Sets a value to the cell referred by the given \p row and \p column.
+    /*!
+        Numbers, booleans and characters are kept as is and converted to text later.
+    */
+    template<typename T>
+    void setCell(RowNumber row, ColumnNumber column, Align align, T && value);
+
+    //! Sets the text of the given \p size to the cell referred by the given \p row and \p column.
+    void setCell(RowNumber row, ColumnNumber column, Align align, const char *data, size_t size);
+
+    //! Sets a cell whose text is made by the \p formatter when it is needed.
+    /*!
+        The formatter is called at most once and released afterwards.
+    */
+    void setDeferredCell(RowNumber row, ColumnNumber column, Align align, Formatter formatter);
+
+    //! Sets the values of the \p rowData container to the given \p row, starting from the first column.
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setRow(RowNumber row, Align align, T && rowData);
+
+    //! Sets the values to the given \p row, starting from the first column.
+    template<typename Value, typename... Ts>
+    void setRow(RowNumber row, Align align, Value && value, Ts &&... restValues);
+
+    //! Sets the values of the \p columnData container to the given \p column, starting from the first row.
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setColumn(ColumnNumber column, Align align, T && columnData);
+
+    //! Returns the number of rows of the table.
+    RowNumber rowCount() const;
+
+    //! Returns the number of columns of the table.
+    ColumnNumber columnCount() const;
+
+    //! Returns the number of cells whose values are not converted to text yet.
+    size_t pendingCount() const;
+
+    //! Returns the text of the cell referred by the given \p row and \p column.
+    /*!
+        Converts the value of the cell, if it is not converted yet.
+        Returns an empty string if the cell is not set.
+    */
+    std::string cellData(RowNumber row, ColumnNumber column) const;
+
+    //! Returns the number of bytes allocated for the table data.
+    size_t memoryUsage() const;
+
+    //! Returns the content widths of the columns, excluding the cell padding.
+    std::vector<size_t> columnWidths() const;
+
+    //! Returns the size of the rendered table in bytes.
+    size_t renderedSize() const;
+
+    //! Renders the table into the \p buffer of the given \p capacity.
+    /*!
+        \returns Returns the size of the rendered table. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Renders the table into the \p buffer using up to \p threadCount threads.
+    /*!
+        Zero \p threadCount means the number of the hardware threads.
+    */
+    size_t renderTo(char *buffer, size_t capacity, unsigned threadCount) const;
+
+    //! Returns the string representation of the table.
+    std::string toString() const;
+
+    //! Returns the string representation of the table rendered with up to \p threadCount threads.
+    std::string toString(unsigned threadCount) const;
+
+    friend TEXTABLE_EXPORT std::ostream &operator<<(std::ostream &os, const LazyTextable &table);
+
+private:
+    /// Defines the kind of the value of a cell.
+    enum class Kind
+    {
+        Empty,    ///< The cell is not set
+        Text,     ///< The text is in the arena
+        Signed,
+        Unsigned,
+        Floating,
+        Bool,
+        Char,
+        Deferred  ///< The text is made by a formatter
+    };
+
+    /// A cell record. The text of the cell is valid only if the cell is formatted.
+    struct Cell
+    {
+        union Value
+        {
+            long long m_signed;
+            unsigned long long m_unsigned;
+            double m_floating;
+            size_t m_formatter; ///< The index of the deferred cell formatter
+        };
+
+        Value m_value = { 0 };
+        uint64_t m_offset : 57;
+        uint64_t m_formatted : 1;
+        uint64_t m_kind : 4;
+        uint64_t m_align : 2;
+        uint32_t m_size = 0;
+        uint32_t m_width = 0;
+
+        Cell()
+            :
+                m_offset(0),
+                m_formatted(1),
+                m_kind(static_cast<uint32_t>(Kind::Empty)),
+                m_align(0)
+        {}
+    };
+
+    using Column = std::vector<Cell>;
+
+    /// Holds the width of a column.
+    struct ColumnWidth
+    {
+        size_t m_width = 0;     ///< The widest cell width.
+        RowNumber m_count = 0;  ///< The number of cells that have the widest width.
+    };
+
+    /// Stores the typed value.
+    void setValue(RowNumber row, ColumnNumber column, Align align, long long value);
+    void setValue(RowNumber row, ColumnNumber column, Align align, unsigned long long value);
+    void setValue(RowNumber row, ColumnNumber column, Align align, double value);
+    void setValue(RowNumber row, ColumnNumber column, Align align, bool value);
+    void setValue(RowNumber row, ColumnNumber column, Align align, char value);
+
+    /// Stores the value of a type that is not kept as is.
+    template<typename T>
+    void setValue(RowNumber row, ColumnNumber column, Align align, T && value);
+
+    /// Returns the cell of the given position, adding it if needed, and clears it.
+    Cell &resetCell(RowNumber row, ColumnNumber column, Align align, Kind kind);
+
+    /// Converts the values of all not formatted cells to text.
+    void formatPending() const;
+
+    /// Converts the value of the \p cell of the given \p column to text.
+    void formatCell(Cell &cell, ColumnNumber column) const;
+
+    /// Updates the \p column width after a cell of the column changed its width.
+    void updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth) const;
+
+    /// Writes the \p row line into \p out and returns the end of the written data.
+    char *writeRow(char *out, const Renderer &renderer, RowNumber row) const;
+
+    /// Rewrites the arena without the text of the overwritten cells.
+    void compact() const;
+
+    /// Returns the size of the rendered \p row line in bytes.
+    size_t rowSize(RowNumber row, size_t lineSize) const;
+
+    /// Returns the size of the rendered table, once all cells are formatted.
+    size_t formattedSize() const;
+
+    // The text cache is filled by the const functions, under the mutex.
+    mutable std::mutex m_mutex;
+    mutable std::string m_arena;
+    mutable std::vector<Column> m_columns;
+    mutable std::vector<ColumnWidth> m_columnWidths;
+    mutable std::vector<Formatter> m_formatters;
+
+    /// The size of the text in the arena, that is not referred by any cell.
+    mutable size_t m_garbage = 0;
+
+    /// The number of bytes all formatted cells take in excess of their display width.
+    mutable size_t m_extraSize = 0;
+
+    /// The number of not formatted cells.
+    mutable size_t m_pendingCount = 0;
+
+    RowNumber m_rowCount = 0;
+};
+
+template<typename T>
+void LazyTextable::setValue(RowNumber row, ColumnNumber column, Align align, T && value)
+{
+    const auto text = Textable::valueToString(std::forward<T>(value));
+    setCell(row, column, align, text.data(), text.size());
+}
+
+template<typename T>
+void LazyTextable::setCell(RowNumber row, ColumnNumber column, Align align, T && value)
+{
+    using Type = typename std::decay<T>::type;
+    static const auto conversion = Textable::ConversionOf<T>::value;
+
+    // Keep the values that are converted without streams, except the long doubles,
+    // that don't fit into a double.
+    using Stored = typename std::conditional<conversion == Textable::Conversion::Signed, long long,
+                   typename std::conditional<conversion == Textable::Conversion::Unsigned, unsigned long long,
+                   typename std::conditional<conversion == Textable::Conversion::Floating &&
+                                             !std::is_same<Type, long double>::value, double,
+                   typename std::conditional<conversion == Textable::Conversion::Bool, bool,
+                   typename std::conditional<conversion == Textable::Conversion::Char, char,
+                                             T &&>::type>::type>::type>::type>::type;
+    setValue(row, column, align, static_cast<Stored>(value));
+}
+
+template<typename T, typename U, typename>
+void LazyTextable::setRow(RowNumber row, Align align, T && rowData)
+{
+    ColumnNumber column = 0;
+    for (const auto &value : rowData) {
+        setCell(row, column++, align, value);
+    }
+}
+
+template<typename Value, typename... Ts>
+void LazyTextable::setRow(RowNumber row, Align align, Value && value, Ts &&... restValues)
+{
+    ColumnNumber column = 0;
+    setCell(row, column++, align, std::forward<Value>(value));
+    const int expand[] = { 0, (setCell(row, column++, align, std::forward<Ts>(restValues)), 0)... };
+    (void)expand;
+}
+
+template<typename T, typename U, typename>
+void LazyTextable::setColumn(ColumnNumber column, Align align, T && columnData)
+{
+    RowNumber row = 0;
+    for (const auto &value : columnData) {
+        setCell(row++, column, align, value);
+    }
+}
+
+#endif // !__LAZYTEXTABLE_H__
@@ -0,0 +1,156 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <string>
+
+#if defined(_WIN32)
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+//! Maps a file into the memory for reading.
+class MappedFile
+{
+public:
+    //! Maps the file of the given \p path.
+    /*!
+        \param readAhead Whether the whole file is going to be read soon, so that
+                         the system can read it ahead.
+    */
+    MappedFile(const std::string &path, bool readAhead)
+    {
+#if defined(_WIN32)
+        m_file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               readAhead ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(m_file, &size)) {
+            return;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+        if (m_size == 0) {
+            m_good = true;
+            return;
+        }
+        m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            return;
+        }
+        m_data = static_cast<const char *>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        m_good = m_data != nullptr;
+#else
+        m_file = ::open(path.c_str(), O_RDONLY);
+        if (m_file < 0) {
+            return;
+        }
+        struct stat status;
+        if (::fstat(m_file, &status) != 0) {
+            return;
+        }
+        m_size = static_cast<size_t>(status.st_size);
+        if (m_size == 0) {
+            m_good = true;
+            return;
+        }
+        auto data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+        if (data == MAP_FAILED) {
+            return;
+        }
+#   if defined(MADV_WILLNEED)
+        if (readAhead) {
+            ::madvise(data, m_size, MADV_WILLNEED);
+        }
+#   else
+        (void)readAhead;
+#   endif
+        m_data = static_cast<const char *>(data);
+        m_good = true;
+#endif
+    }
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (m_data) {
+            ::UnmapViewOfFile(m_data);
+        }
+        if (m_mapping) {
+            ::CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            ::CloseHandle(m_file);
+        }
+#else
+        if (m_data) {
+            ::munmap(const_cast<char *>(m_data), m_size);
+        }
+        if (m_file >= 0) {
+            ::close(m_file);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool good() const
+    {
+        return m_good;
+    }
+
+    const char *data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_file = -1;
+#endif
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+    bool m_good = false;
+};
+
+#endif // !__MAPPEDFILE_H__
@@ -0,0 +1,494 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "mappedtextable.h"
+#include "mappedfile.h"
+#include "renderer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+/// The file header. All sections that follow it are arrays of 8 byte aligned values.
+/*!
+    The file is: the header, the layout (`m_layoutSize` numbers), the row offsets
+    (`m_rowCount + 1` numbers), the cells (`m_cellCount` cells) and the cell texts
+    (`m_textSize` bytes).
+*/
+struct MappedTextable::Header
+{
+    char m_magic[8];
+    uint32_t m_version;
+    uint32_t m_byteOrder;
+    uint64_t m_rowCount;
+    uint64_t m_columnCount;
+    uint64_t m_layoutSize;
+    uint64_t m_cellCount;
+    uint64_t m_textSize;
+};
+
+/// A cell refers to its text in the block of all cell texts.
+struct MappedTextable::Cell
+{
+    uint64_t m_offset;
+    uint32_t m_size;
+    uint32_t m_width : 30;
+    uint32_t m_align : 2;
+};
+
+namespace
+{
+
+const char magic[8] = { 'T', 'E', 'X', 'T', 'A', 'B', 'L', 'E' };
+const uint32_t version = 1;
+const uint32_t byteOrder = 0x01020304;
+
+/// The widths are stored in 30 bits.
+const size_t maxWidth = (1U << 30) - 1;
+
+/// Writes the \p count values to the \p stream.
+template<typename T>
+void writeValues(std::ostream &stream, const T *values, size_t count)
+{
+    stream.write(reinterpret_cast<const char *>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+} // namespace
+
+bool MappedTextable::save(const Textable &table, std::ostream &stream)
+{
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(Cell) == 16, "Unexpected record sizes");
+
+    const auto layout = table.makeRenderer().layout();
+    for (auto value : layout) {
+        if (value > maxWidth) {
+            return false;
+        }
+    }
+
+    // The truncated cells are stored as they are shown. Wrapped cells are not supported.
+    std::string truncated;
+    auto storedText = [&table, &truncated](const Textable::CellData &cell, size_t &width) {
+        if (cell.m_lines == 0) {
+            width = cell.m_width;
+            return std::make_pair(cell.m_data.data(), cell.m_data.size());
+        }
+        const auto &line = table.m_cellLines[cell.m_lines - 1].m_lines.front();
+        truncated.assign(cell.m_data, line.m_offset, line.m_size);
+        truncated += "\xE2\x80\xA6";
+        width = line.m_width + 1;
+        return std::make_pair(truncated.data(), truncated.size());
+    };
+
+    // The row offsets, and the size of the texts.
+    std::vector<uint64_t> rowOffsets;
+    rowOffsets.reserve(table.rowCount() + 1);
+    uint64_t cellCount = 0;
+    uint64_t textSize = 0;
+    for (const auto &row : table.m_table) {
+        rowOffsets.push_back(cellCount);
+        cellCount += row.size();
+        for (const auto &cell : row) {
+            if (cell.m_lines != 0 && !table.m_cellLines[cell.m_lines - 1].m_ellipsis) {
+                return false;
+            }
+            size_t width = 0;
+            const auto text = storedText(cell, width);
+            if (text.second > std::numeric_limits<uint32_t>::max()) {
+                return false;
+            }
+            textSize += text.second;
+        }
+    }
+    rowOffsets.push_back(cellCount);
+
+    Header header;
+    std::memcpy(header.m_magic, magic, sizeof(magic));
+    header.m_version = version;
+    header.m_byteOrder = byteOrder;
+    header.m_rowCount = table.rowCount();
+    header.m_columnCount = table.columnCount();
+    header.m_layoutSize = layout.size();
+    header.m_cellCount = cellCount;
+    header.m_textSize = textSize;
+    writeValues(stream, &header, 1);
+
+    const std::vector<uint64_t> storedLayout(layout.begin(), layout.end());
+    writeValues(stream, storedLayout.data(), storedLayout.size());
+    writeValues(stream, rowOffsets.data(), rowOffsets.size());
+
+    // The cells in batches, so that the memory use is bounded.
+    static const size_t batchSize = 4096;
+    std::vector<Cell> cells;
+    cells.reserve(batchSize);
+    uint64_t offset = 0;
+    for (const auto &row : table.m_table) {
+        for (const auto &cell : row) {
+            size_t width = 0;
+            const auto text = storedText(cell, width);
+            Cell stored;
+            stored.m_offset = offset;
+            stored.m_size = static_cast<uint32_t>(text.second);
+            stored.m_width = static_cast<uint32_t>(width);
+            stored.m_align = static_cast<uint32_t>(cell.m_align);
+            cells.push_back(stored);
+            offset += text.second;
+
+            if (cells.size() == batchSize) {
+                writeValues(stream, cells.data(), cells.size());
+                cells.clear();
+            }
+        }
+    }
+    writeValues(stream, cells.data(), cells.size());
+
+    for (const auto &row : table.m_table) {
+        for (const auto &cell : row) {
+            size_t width = 0;
+            const auto text = storedText(cell, width);
+            stream.write(text.first, static_cast<std::streamsize>(text.second));
+        }
+    }
+
+    return static_cast<bool>(stream);
+}
+
+bool MappedTextable::save(const Textable &table, const std::string &path)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    return stream && save(table, stream) && stream.flush();
+}
+
+MappedTextable::MappedTextable() = default;
+
+MappedTextable::~MappedTextable() = default;
+
+MappedTextable::MappedTextable(MappedTextable &&other)
+{
+    *this = std::move(other);
+}
+
+MappedTextable &MappedTextable::operator=(MappedTextable &&other)
+{
+    if (this != &other) {
+        m_file = std::move(other.m_file);
+        m_rowCount = other.m_rowCount;
+        m_columnCount = other.m_columnCount;
+        m_layout = other.m_layout;
+        m_layoutSize = other.m_layoutSize;
+        m_rowOffsets = other.m_rowOffsets;
+        m_cells = other.m_cells;
+        m_text = other.m_text;
+        m_textSize = other.m_textSize;
+        other.reset();
+    }
+    return *this;
+}
+
+void MappedTextable::reset()
+{
+    m_file.reset();
+    m_rowCount = 0;
+    m_columnCount = 0;
+    m_layout = nullptr;
+    m_layoutSize = 0;
+    m_rowOffsets = nullptr;
+    m_cells = nullptr;
+    m_text = nullptr;
+    m_textSize = 0;
+}
+
+bool MappedTextable::open(const std::string &path)
+{
+    reset();
+    std::unique_ptr<MappedFile> file(new MappedFile(path, false));
+    if (!file->good() || !load(file->data(), file->size())) {
+        return false;
+    }
+    m_file = std::move(file);
+    return true;
+}
+
+bool MappedTextable::load(const char *data, size_t size)
+{
+    reset();
+
+    if (!data || reinterpret_cast<uintptr_t>(data) % 8 != 0 || size < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.m_magic, magic, sizeof(magic)) != 0 || header.m_version != version ||
+        header.m_byteOrder != byteOrder) {
+        return false;
+    }
+
+    // Check the section sizes against the data size, taking care of overflows.
+    auto rest = static_cast<uint64_t>(size - sizeof(Header));
+    auto take = [&rest](uint64_t count, uint64_t itemSize) {
+        if (count > rest / itemSize) {
+            return false;
+        }
+        rest -= count * itemSize;
+        return true;
+    };
+    if (!take(header.m_layoutSize, 8) || !take(header.m_rowCount, 8) || !take(1, 8) ||
+        !take(header.m_cellCount, sizeof(Cell)) || header.m_textSize != rest) {
+        return false;
+    }
+
+    const auto layout = reinterpret_cast<const uint64_t *>(data + sizeof(Header));
+    const auto rowOffsets = layout + header.m_layoutSize;
+    const auto cells = reinterpret_cast<const Cell *>(rowOffsets + header.m_rowCount + 1);
+    const auto text = reinterpret_cast<const char *>(cells + header.m_cellCount);
+
+    // The layout: the column widths, then the decimal aligned columns.
+    const auto columnCount = header.m_columnCount;
+    if (columnCount > header.m_layoutSize || (header.m_layoutSize - columnCount) % 3 != 0) {
+        return false;
+    }
+    for (uint64_t c = 0; c < columnCount; ++c) {
+        if (layout[c] > maxWidth) {
+            return false;
+        }
+    }
+    std::vector<const uint64_t *> decimals(columnCount);
+    for (auto decimal = layout + columnCount; decimal < layout + header.m_layoutSize; decimal += 3) {
+        const auto column = decimal[0];
+        if (column >= columnCount || decimals[column] || decimal[1] > layout[column] ||
+            decimal[2] > layout[column] - decimal[1]) {
+            return false;
+        }
+        decimals[column] = decimal;
+    }
+
+    // The rows and their cells.
+    if (rowOffsets[0] != 0 || rowOffsets[header.m_rowCount] != header.m_cellCount) {
+        return false;
+    }
+    for (uint64_t r = 0; r < header.m_rowCount; ++r) {
+        const auto begin = rowOffsets[r];
+        const auto end = rowOffsets[r + 1];
+        if (end < begin || end - begin > columnCount || end > header.m_cellCount) {
+            return false;
+        }
+        for (auto i = begin; i < end; ++i) {
+            const auto &cell = cells[i];
+            const auto column = i - begin;
+            if (cell.m_offset > header.m_textSize || cell.m_size > header.m_textSize - cell.m_offset ||
+                cell.m_width > cell.m_size || cell.m_width > layout[column] ||
+                cell.m_align > static_cast<uint32_t>(Textable::Align::Center)) {
+                return false;
+            }
+
+            size_t integerWidth = 0;
+            size_t fractionWidth = 0;
+            if (decimals[column] &&
+                Renderer::numberParts(text + cell.m_offset, cell.m_size, integerWidth, fractionWidth) &&
+                (integerWidth > decimals[column][1] || fractionWidth > decimals[column][2])) {
+                return false;
+            }
+        }
+    }
+
+    m_rowCount = static_cast<RowNumber>(header.m_rowCount);
+    m_columnCount = static_cast<ColumnNumber>(columnCount);
+    m_layout = layout;
+    m_layoutSize = static_cast<size_t>(header.m_layoutSize);
+    m_rowOffsets = rowOffsets;
+    m_cells = cells;
+    m_text = text;
+    m_textSize = header.m_textSize;
+    return true;
+}
+
+MappedTextable::RowNumber MappedTextable::rowCount() const
+{
+    return m_rowCount;
+}
+
+MappedTextable::ColumnNumber MappedTextable::columnCount() const
+{
+    return m_columnCount;
+}
+
+std::string MappedTextable::cellData(RowNumber row, ColumnNumber column) const
+{
+    if (row >= m_rowCount || column >= m_rowOffsets[row + 1] - m_rowOffsets[row]) {
+        return {};
+    }
+    const auto &cell = m_cells[m_rowOffsets[row] + column];
+    return std::string(m_text + cell.m_offset, cell.m_size);
+}
+
+std::vector<size_t> MappedTextable::columnWidths() const
+{
+    return std::vector<size_t>(m_layout, m_layout + m_columnCount);
+}
+
+Renderer MappedTextable::makeRenderer() const
+{
+    Renderer renderer(columnWidths());
+    for (auto decimal = m_layout + m_columnCount; decimal < m_layout + m_layoutSize; decimal += 3) {
+        renderer.setDecimalAlign(static_cast<ColumnNumber>(decimal[0]), static_cast<size_t>(decimal[1]),
+                                 static_cast<size_t>(decimal[2]));
+    }
+    return renderer;
+}
+
+size_t MappedTextable::rowSize(const Renderer &renderer, RowNumber row) const
+{
+    auto size = renderer.lineSize();
+    for (auto i = m_rowOffsets[row]; i < m_rowOffsets[row + 1]; ++i) {
+        size += m_cells[i].m_size - m_cells[i].m_width;
+    }
+    return size;
+}
+
+char *MappedTextable::writeRow(const Renderer &renderer, char *out, RowNumber row) const
+{
+    const auto cells = m_cells + m_rowOffsets[row];
+    const auto cellCount = static_cast<ColumnNumber>(m_rowOffsets[row + 1] - m_rowOffsets[row]);
+
+    *out++ = '|';
+    for (ColumnNumber c = 0; c < m_columnCount; ++c) {
+        if (c < cellCount) {
+            const auto &cell = cells[c];
+            out = renderer.writeAlignedCell(out, c, m_text + cell.m_offset, cell.m_size, cell.m_width,
+                                            static_cast<Textable::Align>(cell.m_align));
+        } else {
+            out = renderer.writeEmptyCell(out, c);
+        }
+        *out++ = '|';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+size_t MappedTextable::renderedSize() const
+{
+    if (m_rowCount == 0) {
+        return 0;
+    }
+
+    const auto renderer = makeRenderer();
+    auto size = renderer.lineSize();
+    for (RowNumber r = 0; r < m_rowCount; ++r) {
+        size += rowSize(renderer, r) + renderer.lineSize();
+    }
+    return size;
+}
+
+size_t MappedTextable::renderTo(char *buffer, size_t capacity) const
+{
+    const auto size = renderedSize();
+    if (size == 0 || size > capacity) {
+        return size;
+    }
+
+    const auto renderer = makeRenderer();
+    auto out = renderer.writeBorder(buffer);
+    for (RowNumber r = 0; r < m_rowCount; ++r) {
+        out = writeRow(renderer, out, r);
+        out = renderer.writeBorder(out);
+    }
+    assert(out == buffer + size);
+    return size;
+}
+
+std::string MappedTextable::toString() const
+{
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size());
+    }
+    return result;
+}
+
+Textable MappedTextable::toTextable() const
+{
+    Textable table;
+    table.reserve(m_rowCount, m_columnCount);
+
+    std::vector<size_t> widths(m_columnCount);
+    for (RowNumber r = 0; r < m_rowCount; ++r) {
+        Textable::Row row;
+        row.reserve(static_cast<size_t>(m_rowOffsets[r + 1] - m_rowOffsets[r]));
+        for (auto i = m_rowOffsets[r]; i < m_rowOffsets[r + 1]; ++i) {
+            const auto &cell = m_cells[i];
+            widths[row.size()] = std::max<size_t>(widths[row.size()], cell.m_width);
+            row.emplace_back(std::string(m_text + cell.m_offset, cell.m_size),
+                             static_cast<Textable::Align>(cell.m_align));
+        }
+        table.appendRow(std::move(row));
+    }
+
+    // Keep the columns that are wider than their cells, and the decimal alignment.
+    std::vector<Textable::ColumnFormat> formats(m_columnCount);
+    std::vector<bool> formatted(m_columnCount);
+    for (ColumnNumber c = 0; c < m_columnCount; ++c) {
+        if (m_layout[c] > widths[c]) {
+            formats[c].m_width = static_cast<size_t>(m_layout[c]);
+            formatted[c] = true;
+        }
+    }
+    for (auto decimal = m_layout + m_columnCount; decimal < m_layout + m_layoutSize; decimal += 3) {
+        formats[decimal[0]].m_decimalAlign = true;
+        formatted[decimal[0]] = true;
+    }
+    for (ColumnNumber c = 0; c < m_columnCount; ++c) {
+        if (formatted[c]) {
+            table.setColumnFormat(c, formats[c]);
+        }
+    }
+    return table;
+}
+
+std::ostream &operator<<(std::ostream &os, const MappedTextable &table)
+{
+    if (table.m_rowCount == 0) {
+        return os;
+    }
+
+    const auto renderer = table.makeRenderer();
+    const auto &border = renderer.border();
+
+    // A single buffer for all rows.
+    std::string buffer;
+
+    os.write(border.data(), border.size());
+    for (MappedTextable::RowNumber r = 0; r < table.m_rowCount; ++r) {
+        const auto size = table.rowSize(renderer, r);
+        if (size > buffer.size()) {
+            buffer.resize(size);
+        }
+        table.writeRow(renderer, &buffer[0], r);
+        os.write(buffer.data(), size);
+        os.write(border.data(), border.size());
+    }
+    return os;
+}
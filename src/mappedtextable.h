@@ -0,0 +1,172 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __MAPPEDTEXTABLE_H__
+#define __MAPPEDTEXTABLE_H__
+
+#include "textable.h"
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class MappedFile;
+class Renderer;
+
+//! Implements a read only table stored in a compact binary format.
+/*!
+    A table saved with `save()` can be loaded by another process by memory mapping the
+    file. The format keeps the table shape and column layout, the display width and the
+    alignment of each cell, and a single block of all cell texts, so that loading needs
+    neither parsing nor per-cell allocations, and the table is rendered straight from
+    the mapped data. The data is checked on loading, but the cell texts are not read,
+    except the ones of the decimal aligned columns.
+
+    The output is the same as the one of the saved table, including the column formats
+    (minimal widths and decimal point alignment). The format uses the byte order of
+    the saving machine, and is rejected by machines of the other byte order.
+
+    \example
+        // The batch job.
+        MappedTextable::save(textable, "report.tbl");
+
+        // The renderer process.
+        MappedTextable report;
+        if (report.open("report.tbl")) {
+            std::cout << report;
+        }
+*/
+class TEXTABLE_EXPORT MappedTextable
+{
+public:
+    using RowNumber    = Textable::RowNumber;
+    using ColumnNumber = Textable::ColumnNumber;
+
+    //! Writes the \p table into the binary \p stream.
+    /*!
+        The truncated cells of width limited columns are stored as they are shown.
+        \returns Returns false if writing has failed, a cell is too large for the format,
+                 or the table has wrapped cells, which the format doesn't support.
+    */
+    static bool save(const Textable &table, std::ostream &stream);
+
+    //! Writes the \p table into the file of the given \p path.
+    static bool save(const Textable &table, const std::string &path);
+
+    //! Constructs an empty table.
+    MappedTextable();
+
+    //! Destroys the table and unmaps its file.
+    ~MappedTextable();
+
+    MappedTextable(MappedTextable &&other);
+    MappedTextable &operator=(MappedTextable &&other);
+
+    //! Maps the saved table of the given \p path.
+    /*!
+        \returns Returns false if the file can't be mapped or is not a valid table. The
+                 table is empty then.
+    */
+    bool open(const std::string &path);
+
+    //! Loads the saved table from the given memory.
+    /*!
+        The data is not copied, so it should outlive the table. The data should be
+        aligned to 8 bytes, as allocated memory is.
+        \returns Returns false if the data is not a valid table. The table is empty then.
+    */
+    bool load(const char *data, size_t size);
+
+    //! Returns the number of rows.
+    RowNumber rowCount() const;
+
+    //! Returns the number of columns.
+    ColumnNumber columnCount() const;
+
+    //! Returns the text of the cell referred by the given \p row and \p column.
+    /*!
+        Returns an empty string if there is no such cell.
+    */
+    std::string cellData(RowNumber row, ColumnNumber column) const;
+
+    //! Returns the content widths of the columns.
+    std::vector<size_t> columnWidths() const;
+
+    //! Returns the size of the rendered table in bytes.
+    size_t renderedSize() const;
+
+    //! Renders the table into the \p buffer of the given \p capacity.
+    /*!
+        \returns Returns the size of the rendered table. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Returns the string representation of the table.
+    std::string toString() const;
+
+    //! Returns a `Textable` with the cells of the table.
+    /*!
+        The `Textable` renders the same output, i.e. the columns that are wider than
+        their cells and the decimal aligned columns get the corresponding formats.
+    */
+    Textable toTextable() const;
+
+    friend TEXTABLE_EXPORT std::ostream &operator<<(std::ostream &os, const MappedTextable &table);
+
+private:
+    struct Header;
+    struct Cell;
+
+    /// Makes the table empty.
+    void reset();
+
+    /// Returns a renderer of the stored column layout.
+    Renderer makeRenderer() const;
+
+    /// Returns the size of the rendered \p row line.
+    size_t rowSize(const Renderer &renderer, RowNumber row) const;
+
+    /// Writes the \p row line into \p out and returns the end of the written data.
+    char *writeRow(const Renderer &renderer, char *out, RowNumber row) const;
+
+    std::unique_ptr<MappedFile> m_file;
+
+    RowNumber m_rowCount = 0;
+    ColumnNumber m_columnCount = 0;
+
+    /// The column widths followed by the (column, integer width, fraction width)
+    /// triplets of the decimal aligned columns.
+    const uint64_t *m_layout = nullptr;
+    size_t m_layoutSize = 0;
+
+    /// The index of the first cell of each row, and the number of cells at the end.
+    const uint64_t *m_rowOffsets = nullptr;
+    const Cell *m_cells = nullptr;
+    const char *m_text = nullptr;
+    uint64_t m_textSize = 0;
+};
+
+#endif // !__MAPPEDTEXTABLE_H__
@@ -0,0 +1,110 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Implements helpers for the data parallel algorithms of the library.
+namespace parallel
+{
+
+//! Returns the number of threads to use for the \p requested number of threads.
+/*!
+    Zero means the number of hardware threads.
+*/
+inline unsigned threadCount(unsigned requested)
+{
+    if (requested == 0) {
+        requested = std::thread::hardware_concurrency();
+    }
+    return std::max(requested, 1U);
+}
+
+//! Returns the number of slices to split \p count items into.
+/*!
+    Each slice gets at least \p minSliceSize items, so that small inputs are not split at all.
+*/
+inline unsigned sliceCount(size_t count, unsigned threads, size_t minSliceSize)
+{
+    const auto maxSlices = std::max<size_t>(count / std::max<size_t>(minSliceSize, 1), 1);
+    return static_cast<unsigned>(std::min<size_t>(threads, maxSlices));
+}
+
+//! Calls the \p function for each of the \p slices of \p count items in parallel.
+/*!
+    The function is called as `function(slice, begin, end)`. The calling thread processes
+    the first slice itself, and the slices no thread could be started for. If the function
+    throws, the first exception is rethrown once all slices are processed.
+*/
+template<typename Function>
+void forEachSlice(size_t count, unsigned slices, Function &&function)
+{
+    slices = std::max(slices, 1U);
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto run = [&](unsigned slice) {
+        try {
+            function(slice, count * slice / slices, count * (slice + 1) / slices);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    unsigned slice = 1;
+    try {
+        threads.reserve(slices - 1);
+        for (; slice < slices; ++slice) {
+            threads.emplace_back(run, slice);
+        }
+    } catch (...) {
+        // Out of threads, process the rest of the slices here.
+    }
+
+    run(0U);
+    for (; slice < slices; ++slice) {
+        run(slice);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace parallel
+
+#endif // !__PARALLEL_H__
@@ -0,0 +1,361 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "renderer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+const size_t Renderer::padding;
+
+namespace
+{
+
+/// The ending of truncated cells, one column wide.
+const char ellipsis[] = "\xE2\x80\xA6";
+const size_t ellipsisSize = sizeof(ellipsis) - 1;
+
+} // namespace
+
+Renderer::Renderer(std::vector<size_t> widths)
+    :
+        m_widths(std::move(widths))
+{
+    size_t size = 2; // The leading '+' and the line break.
+    for (auto width : m_widths) {
+        size += width + padding + 1;
+    }
+
+    m_border.reserve(size);
+    m_border += '+';
+    for (auto width : m_widths) {
+        m_border.append(width + padding, '-');
+        m_border += '+';
+    }
+    m_border += '\n';
+}
+
+Renderer::ColumnNumber Renderer::columnCount() const
+{
+    return m_widths.size();
+}
+
+size_t Renderer::columnWidth(ColumnNumber column) const
+{
+    return m_widths.at(column);
+}
+
+const std::vector<size_t> &Renderer::columnWidths() const
+{
+    return m_widths;
+}
+
+Renderer Renderer::columns(ColumnNumber first, ColumnNumber last) const
+{
+    assert(first <= last && last <= m_widths.size());
+
+    Renderer renderer(std::vector<size_t>(m_widths.begin() + first, m_widths.begin() + last));
+    renderer.m_cellLines = m_cellLines;
+    for (auto c = first; c < last && c < m_decimals.size(); ++c) {
+        if (m_decimals[c].m_enabled) {
+            renderer.setDecimalAlign(c - first, m_decimals[c].m_integerWidth, m_decimals[c].m_fractionWidth);
+        }
+    }
+    return renderer;
+}
+
+void Renderer::setDecimalAlign(ColumnNumber column, size_t integerWidth, size_t fractionWidth)
+{
+    assert(integerWidth + fractionWidth <= m_widths.at(column));
+
+    if (m_decimals.size() < m_widths.size()) {
+        m_decimals.resize(m_widths.size());
+    }
+    auto &decimal = m_decimals[column];
+    decimal.m_enabled = true;
+    decimal.m_integerWidth = integerWidth;
+    decimal.m_fractionWidth = fractionWidth;
+}
+
+void Renderer::setCellLines(const std::vector<Textable::CellLines> *cellLines)
+{
+    m_cellLines = cellLines;
+}
+
+bool Renderer::numberParts(const char *data, size_t size, size_t &integerWidth, size_t &fractionWidth)
+{
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+    size_t i = 0;
+    if (i < size && (data[i] == '-' || data[i] == '+')) {
+        ++i;
+    }
+    if (i == size || !isDigit(data[i])) {
+        return false;
+    }
+    while (i < size && (isDigit(data[i]) || data[i] == ',' || data[i] == '\'' || data[i] == ' ')) {
+        ++i;
+    }
+    integerWidth = i;
+
+    if (i < size && data[i] == '.') {
+        ++i;
+        while (i < size && isDigit(data[i])) {
+            ++i;
+        }
+    }
+    if (i < size && (data[i] == 'e' || data[i] == 'E')) {
+        ++i;
+        if (i < size && (data[i] == '-' || data[i] == '+')) {
+            ++i;
+        }
+        if (i == size || !isDigit(data[i])) {
+            return false;
+        }
+        while (i < size && isDigit(data[i])) {
+            ++i;
+        }
+    }
+    if (i != size) {
+        return false;
+    }
+
+    fractionWidth = size - integerWidth;
+    return true;
+}
+
+std::vector<size_t> Renderer::layout() const
+{
+    auto result = m_widths;
+    for (ColumnNumber c = 0; c < m_decimals.size(); ++c) {
+        if (m_decimals[c].m_enabled) {
+            result.insert(result.end(), { c, m_decimals[c].m_integerWidth, m_decimals[c].m_fractionWidth });
+        }
+    }
+    return result;
+}
+
+size_t Renderer::lineSize() const
+{
+    return m_border.size();
+}
+
+size_t Renderer::rowSize(const Textable::Row &row) const
+{
+    assert(row.size() <= m_widths.size());
+    return rowSize(row, 0);
+}
+
+size_t Renderer::rowSize(const Textable::Row &row, ColumnNumber firstColumn) const
+{
+    auto size = lineSize();
+    const auto end = std::min(row.size(), firstColumn + m_widths.size());
+    if (!m_cellLines) {
+        for (auto c = firstColumn; c < end; ++c) {
+            size += row[c].m_data.size() - row[c].m_width;
+        }
+        return size;
+    }
+
+    size_t lineCount = 1;
+    for (auto c = firstColumn; c < end; ++c) {
+        const auto &cell = row[c];
+        if (cell.m_lines == 0) {
+            size += cell.m_data.size() - cell.m_width;
+            continue;
+        }
+        const auto &lines = (*m_cellLines)[cell.m_lines - 1];
+        for (const auto &line : lines.m_lines) {
+            size += line.m_size - line.m_width;
+        }
+        if (lines.m_ellipsis) {
+            size += ellipsisSize - 1;
+        }
+        lineCount = std::max(lineCount, lines.m_lines.size());
+    }
+    return size + (lineCount - 1) * lineSize();
+}
+
+size_t Renderer::rowLineCount(const Textable::Row &row, ColumnNumber firstColumn) const
+{
+    size_t lineCount = 1;
+    const auto end = std::min(row.size(), firstColumn + m_widths.size());
+    for (auto c = firstColumn; c < end; ++c) {
+        if (row[c].m_lines != 0) {
+            lineCount = std::max(lineCount, (*m_cellLines)[row[c].m_lines - 1].m_lines.size());
+        }
+    }
+    return lineCount;
+}
+
+const std::string &Renderer::border() const
+{
+    return m_border;
+}
+
+char *Renderer::writeBorder(char *out) const
+{
+    std::memcpy(out, m_border.data(), m_border.size());
+    return out + m_border.size();
+}
+
+char *Renderer::writeRow(char *out, const Textable::Row &row) const
+{
+    assert(row.size() <= m_widths.size());
+    return writeRow(out, row, 0);
+}
+
+char *Renderer::writeRow(char *out, const Textable::Row &row, ColumnNumber firstColumn) const
+{
+    // A row with wrapped cells takes several lines.
+    const auto lineCount = m_cellLines ? rowLineCount(row, firstColumn) : 1;
+    for (size_t line = 0; line < lineCount; ++line) {
+        *out++ = '|';
+        for (ColumnNumber c = 0; c < m_widths.size(); ++c) {
+            if (firstColumn + c < row.size()) {
+                const auto &cell = row[firstColumn + c];
+                if (m_cellLines && cell.m_lines != 0) {
+                    out = writeCellLine(out, c, cell, (*m_cellLines)[cell.m_lines - 1], line);
+                } else if (line == 0) {
+                    out = writeAlignedCell(out, c, cell.m_data.data(), cell.m_data.size(), cell.m_width,
+                                           cell.m_align);
+                } else {
+                    out = writeEmptyCell(out, c);
+                }
+            } else {
+                out = writeEmptyCell(out, c);
+            }
+            *out++ = '|';
+        }
+        *out++ = '\n';
+    }
+    return out;
+}
+
+char *Renderer::writeCellLine(char *out, ColumnNumber column, const Textable::CellData &cell,
+                              const Textable::CellLines &lines, size_t line) const
+{
+    if (line >= lines.m_lines.size()) {
+        return writeEmptyCell(out, column);
+    }
+
+    const auto &cellLine = lines.m_lines[line];
+    const auto data = cell.m_data.data() + cellLine.m_offset;
+    if (!lines.m_ellipsis) {
+        return writeCell(out, column, data, cellLine.m_size, cellLine.m_width, cell.m_align);
+    }
+
+    // Write the truncated text with the ellipsis as a whole.
+    const auto width = cellLine.m_width + 1;
+    assert(width <= m_widths[column]);
+    const auto spaceCount = m_widths[column] + padding - width;
+
+    size_t leftSpace = 0;
+    if (cell.m_align == Textable::Align::Right) {
+        leftSpace = spaceCount;
+    } else if (cell.m_align == Textable::Align::Center) {
+        leftSpace = spaceCount / 2;
+    }
+
+    std::memset(out, ' ', leftSpace);
+    out += leftSpace;
+    std::memcpy(out, data, cellLine.m_size);
+    out += cellLine.m_size;
+    std::memcpy(out, ellipsis, ellipsisSize);
+    out += ellipsisSize;
+    std::memset(out, ' ', spaceCount - leftSpace);
+    return out + spaceCount - leftSpace;
+}
+
+char *Renderer::writeCell(char *out, ColumnNumber column, const char *data, size_t size,
+                          size_t width, Textable::Align align) const
+{
+    assert(width <= m_widths[column]);
+
+    const auto spaceCount = m_widths[column] + padding - width;
+
+    size_t leftSpace = 0;
+    if (align == Textable::Align::Right) {
+        leftSpace = spaceCount;
+    } else if (align == Textable::Align::Center) {
+        leftSpace = spaceCount / 2;
+    }
+
+    std::memset(out, ' ', leftSpace);
+    out += leftSpace;
+    if (size > 0) {
+        std::memcpy(out, data, size);
+        out += size;
+    }
+    std::memset(out, ' ', spaceCount - leftSpace);
+    return out + spaceCount - leftSpace;
+}
+
+char *Renderer::writeAlignedCell(char *out, ColumnNumber column, const char *data, size_t size,
+                                 size_t width, Textable::Align align) const
+{
+    size_t integerWidth = 0;
+    size_t fractionWidth = 0;
+    if (column < m_decimals.size() && m_decimals[column].m_enabled &&
+        numberParts(data, size, integerWidth, fractionWidth)) {
+        return writeNumber(out, column, data, size, integerWidth, align);
+    }
+    return writeCell(out, column, data, size, width, align);
+}
+
+char *Renderer::writeNumber(char *out, ColumnNumber column, const char *data, size_t size,
+                            size_t integerWidth, Textable::Align align) const
+{
+    const auto &decimal = m_decimals[column];
+    assert(integerWidth <= decimal.m_integerWidth);
+
+    // Align the block of numbers within the column first.
+    const auto blockWidth = decimal.m_integerWidth + decimal.m_fractionWidth;
+    const auto blockSpace = m_widths[column] + padding - blockWidth;
+
+    size_t leftSpace = 0;
+    if (align == Textable::Align::Right) {
+        leftSpace = blockSpace;
+    } else if (align == Textable::Align::Center) {
+        leftSpace = blockSpace / 2;
+    }
+    leftSpace += decimal.m_integerWidth - integerWidth;
+
+    // Numbers are ASCII, so the size is also the width.
+    const auto spaceCount = m_widths[column] + padding - size;
+    std::memset(out, ' ', leftSpace);
+    out += leftSpace;
+    std::memcpy(out, data, size);
+    out += size;
+    std::memset(out, ' ', spaceCount - leftSpace);
+    return out + spaceCount - leftSpace;
+}
+
+char *Renderer::writeEmptyCell(char *out, ColumnNumber column) const
+{
+    const auto spaceCount = m_widths[column] + padding;
+    std::memset(out, ' ', spaceCount);
+    return out + spaceCount;
+}
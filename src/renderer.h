@@ -0,0 +1,187 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __RENDERER_H__
+#define __RENDERER_H__
+
+#include "textable.h"
+
+#include <string>
+#include <vector>
+
+//! Implements the low level rendering of table lines into character buffers.
+/*!
+    Once the column widths are known every table line has a predictable size:
+    a border line is always `lineSize()` bytes long, and a row line is longer only
+    by the number of bytes its multi-byte characters take in excess of their display
+    width. This allows computing the exact output size up front and writing the
+    table into a single preallocated buffer with no intermediate allocations.
+
+    The border line is built once, on construction, and copied as a whole.
+*/
+class TEXTABLE_EXPORT Renderer
+{
+public:
+    using ColumnNumber = Textable::ColumnNumber;
+
+    //! Constructs a renderer for the columns of the given content \p widths.
+    /*!
+        The widths don't include the single space padding on both sides of a cell.
+    */
+    explicit Renderer(std::vector<size_t> widths);
+
+    //! Returns the number of columns.
+    ColumnNumber columnCount() const;
+
+    //! Returns the content width of the given \p column.
+    size_t columnWidth(ColumnNumber column) const;
+
+    //! Returns the content widths of all columns.
+    const std::vector<size_t> &columnWidths() const;
+
+    //! Returns a renderer of the [\p first, \p last) range of the columns.
+    /*!
+        The columns keep their widths and decimal point alignment, so that the lines of
+        the range line up with the corresponding parts of the full table lines.
+    */
+    Renderer columns(ColumnNumber first, ColumnNumber last) const;
+
+    //! Aligns the numbers of the given \p column by the decimal point.
+    /*!
+        Numeric cells (see `numberParts()`) are placed so that their decimal points line up.
+        The block of numbers is aligned within the column according to the cell alignment.
+        \param column        The column
+        \param integerWidth  The widest integer part, i.e. the part before the decimal point
+        \param fractionWidth The widest fraction part, including the decimal point and exponent
+    */
+    void setDecimalAlign(ColumnNumber column, size_t integerWidth, size_t fractionWidth);
+
+    //! Renders the cells that have cached lines (see `Textable::CellData::m_lines`) with them.
+    /*!
+        Such cells are truncated, or span several lines of their row. The lines should
+        outlive the renderer.
+    */
+    void setCellLines(const std::vector<Textable::CellLines> *cellLines);
+
+    //! Splits the number \p data into the integer and fraction parts.
+    /*!
+        A number has an optional sign, digits with optional thousands separators, an optional
+        decimal point followed by digits, and an optional exponent.
+        \returns Returns false if the data is not a number.
+    */
+    static bool numberParts(const char *data, size_t size, size_t &integerWidth, size_t &fractionWidth);
+
+    //! Returns the layout of the columns: their widths and decimal point alignments.
+    /*!
+        Renderers with equal layouts render equal rows equally.
+    */
+    std::vector<size_t> layout() const;
+
+    //! Returns the size of a border line in bytes, including the line break.
+    /*!
+        A row line without multi-byte characters has exactly the same size.
+    */
+    size_t lineSize() const;
+
+    //! Returns the size of the rendered \p row line in bytes.
+    /*!
+        A row with wrapped cells takes several lines, and the size includes all of them.
+    */
+    size_t rowSize(const Textable::Row &row) const;
+
+    //! Returns the size of the rendered \p row line, that starts at the \p firstColumn of the row.
+    /*!
+        The row cells beyond the renderer columns are not rendered.
+    */
+    size_t rowSize(const Textable::Row &row, ColumnNumber firstColumn) const;
+
+    //! Returns the border line, including the line break.
+    const std::string &border() const;
+
+    //! Writes the border line into \p out and returns the end of the written data.
+    char *writeBorder(char *out) const;
+
+    //! Writes the \p row line into \p out and returns the end of the written data.
+    /*!
+        The output should have at least `rowSize(row)` bytes available.
+    */
+    char *writeRow(char *out, const Textable::Row &row) const;
+
+    //! Writes the \p row line, that starts at the \p firstColumn of the row.
+    /*!
+        The output should have at least `rowSize(row, firstColumn)` bytes available.
+    */
+    char *writeRow(char *out, const Textable::Row &row, ColumnNumber firstColumn) const;
+
+    //! Writes a single cell, including its padding but without the separators.
+    /*!
+        \param out    The output buffer
+        \param column The column of the cell
+        \param data   The cell text
+        \param size   The size of the cell text in bytes
+        \param width  The display width of the cell text
+        \param align  The cell text alignment
+        \returns Returns the end of the written data.
+    */
+    char *writeCell(char *out, ColumnNumber column, const char *data, size_t size,
+                    size_t width, Textable::Align align) const;
+
+    //! Writes a single cell as `writeCell()` does, but aligns a number by the decimal point,
+    //! if the \p column is decimal aligned.
+    char *writeAlignedCell(char *out, ColumnNumber column, const char *data, size_t size,
+                           size_t width, Textable::Align align) const;
+
+    //! Writes an empty cell of the given \p column.
+    char *writeEmptyCell(char *out, ColumnNumber column) const;
+
+    //! The single space padding on each side of a cell content.
+    static const size_t padding = 2;
+
+private:
+    /// Returns the number of lines the \p row takes, starting at the \p firstColumn.
+    size_t rowLineCount(const Textable::Row &row, ColumnNumber firstColumn) const;
+
+    /// Writes the given \p line of a cell with the cached \p lines.
+    char *writeCellLine(char *out, ColumnNumber column, const Textable::CellData &cell,
+                        const Textable::CellLines &lines, size_t line) const;
+
+    /// Writes a number aligned by the decimal point.
+    char *writeNumber(char *out, ColumnNumber column, const char *data, size_t size,
+                      size_t integerWidth, Textable::Align align) const;
+
+    /// The decimal point alignment of a column.
+    struct DecimalAlign
+    {
+        bool m_enabled = false;
+        size_t m_integerWidth = 0;
+        size_t m_fractionWidth = 0;
+    };
+
+    std::vector<size_t> m_widths;
+    std::vector<DecimalAlign> m_decimals;
+    std::string m_border;
+    const std::vector<Textable::CellLines> *m_cellLines = nullptr;
+};
+
+#endif // !__RENDERER_H__
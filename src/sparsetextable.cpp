@@ -0,0 +1,284 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "sparsetextable.h"
+#include "renderer.h"
+#include "unicode.h"
+
+#include <cassert>
+#include <cstring>
+
+void SparseTextable::storeCell(RowNumber row, ColumnNumber column, Align align, std::string && text)
+{
+    m_rowCount = std::max(m_rowCount, row + 1);
+
+    auto &entries = m_rows[row];
+    const ColumnNumber oldSize = entries.empty() ? 0 : entries.back().m_column + 1;
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), column,
+                               [](const Entry &entry, ColumnNumber c) { return entry.m_column < c; });
+    if (it == entries.end() || it->m_column != column) {
+        it = entries.insert(it, Entry{ column, {} });
+        ++m_cellCount;
+    }
+
+    auto &cell = it->m_cell;
+    const auto oldWidth = cell.m_width;
+    m_extraSize -= cell.m_data.size() - cell.m_width;
+
+    cell.m_data = std::move(text);
+    cell.m_align = align;
+    cell.m_width = Unicode::displayWidth(cell.m_data);
+    m_extraSize += cell.m_data.size() - cell.m_width;
+
+    updateRowSize(oldSize, entries.back().m_column + 1);
+    updateColumnWidth(column, oldWidth, cell.m_width);
+}
+
+void SparseTextable::clearRow(RowNumber row)
+{
+    const auto it = m_rows.find(row);
+    if (it == m_rows.end()) {
+        return;
+    }
+
+    const auto entries = std::move(it->second);
+    m_rows.erase(it);
+    m_cellCount -= entries.size();
+    if (!entries.empty()) {
+        updateRowSize(entries.back().m_column + 1, 0);
+    }
+    for (const auto &entry : entries) {
+        m_extraSize -= entry.m_cell.m_data.size() - entry.m_cell.m_width;
+        updateColumnWidth(entry.m_column, entry.m_cell.m_width, 0);
+    }
+}
+
+void SparseTextable::updateRowSize(ColumnNumber oldSize, ColumnNumber newSize)
+{
+    if (oldSize == newSize) {
+        return;
+    }
+    if (oldSize > 0) {
+        const auto it = m_rowSizes.find(oldSize);
+        assert(it != m_rowSizes.end());
+        if (--it->second == 0) {
+            m_rowSizes.erase(it);
+        }
+    }
+    if (newSize > 0) {
+        ++m_rowSizes[newSize];
+    }
+}
+
+void SparseTextable::updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth)
+{
+    if (oldWidth == newWidth) {
+        return;
+    }
+
+    if (column >= m_columnWidths.size()) {
+        m_columnWidths.resize(column + 1);
+    }
+    auto &columnWidth = m_columnWidths[column];
+
+    if (newWidth > columnWidth.m_width) {
+        columnWidth.m_width = newWidth;
+        columnWidth.m_count = 1;
+    } else if (newWidth == columnWidth.m_width && newWidth > 0) {
+        ++columnWidth.m_count;
+    }
+
+    if (oldWidth == columnWidth.m_width && oldWidth > 0 && --columnWidth.m_count == 0) {
+        // The widest cell got narrower, find the new widest ones among the occupied cells.
+        columnWidth = {};
+        for (const auto &row : m_rows) {
+            const auto &entries = row.second;
+            const auto it = std::lower_bound(entries.begin(), entries.end(), column,
+                                             [](const Entry &entry, ColumnNumber c) { return entry.m_column < c; });
+            if (it == entries.end() || it->m_column != column) {
+                continue;
+            }
+            const auto width = it->m_cell.m_width;
+            if (width > columnWidth.m_width) {
+                columnWidth.m_width = width;
+                columnWidth.m_count = 1;
+            } else if (width == columnWidth.m_width && width > 0) {
+                ++columnWidth.m_count;
+            }
+        }
+    }
+}
+
+SparseTextable::RowNumber SparseTextable::rowCount() const
+{
+    return m_rowCount;
+}
+
+SparseTextable::ColumnNumber SparseTextable::columnCount() const
+{
+    return m_rowSizes.empty() ? 0 : m_rowSizes.rbegin()->first;
+}
+
+size_t SparseTextable::cellCount() const
+{
+    return m_cellCount;
+}
+
+std::string SparseTextable::cellData(RowNumber row, ColumnNumber column) const
+{
+    const auto rowIt = m_rows.find(row);
+    if (rowIt == m_rows.end()) {
+        return {};
+    }
+    const auto &entries = rowIt->second;
+    const auto it = std::lower_bound(entries.begin(), entries.end(), column,
+                                     [](const Entry &entry, ColumnNumber c) { return entry.m_column < c; });
+    return it != entries.end() && it->m_column == column ? it->m_cell.m_data : std::string{};
+}
+
+std::vector<size_t> SparseTextable::columnWidths() const
+{
+    const auto count = columnCount();
+    std::vector<size_t> widths(count);
+    for (ColumnNumber c = 0; c < count && c < m_columnWidths.size(); ++c) {
+        widths[c] = m_columnWidths[c].m_width;
+    }
+    return widths;
+}
+
+size_t SparseTextable::renderedSize() const
+{
+    if (m_rowCount == 0) {
+        return 0;
+    }
+
+    // All lines have the same size, except the bytes of multi-byte characters.
+    size_t lineSize = 1 + 1;
+    const auto count = columnCount();
+    for (ColumnNumber c = 0; c < count; ++c) {
+        lineSize += (c < m_columnWidths.size() ? m_columnWidths[c].m_width : 0) + Renderer::padding + 1;
+    }
+    return lineSize * (2 * m_rowCount + 1) + m_extraSize;
+}
+
+size_t SparseTextable::rowSize(const Entries &entries, size_t lineSize) const
+{
+    auto size = lineSize;
+    for (const auto &entry : entries) {
+        size += entry.m_cell.m_data.size() - entry.m_cell.m_width;
+    }
+    return size;
+}
+
+char *SparseTextable::writeRow(char *out, const Renderer &renderer, const Entries &entries) const
+{
+    auto entry = entries.begin();
+
+    *out++ = '|';
+    for (ColumnNumber c = 0; c < renderer.columnCount(); ++c) {
+        if (entry != entries.end() && entry->m_column == c) {
+            const auto &cell = entry->m_cell;
+            out = renderer.writeCell(out, c, cell.m_data.data(), cell.m_data.size(), cell.m_width, cell.m_align);
+            ++entry;
+        } else {
+            out = renderer.writeEmptyCell(out, c);
+        }
+        *out++ = '|';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+size_t SparseTextable::renderTo(char *buffer, size_t capacity) const
+{
+    const auto size = renderedSize();
+    if (size == 0 || size > capacity) {
+        return size;
+    }
+
+    const Renderer renderer(columnWidths());
+    const auto &border = renderer.border();
+
+    // The empty rows are copies of the same line.
+    std::string emptyRow(renderer.lineSize(), ' ');
+    writeRow(&emptyRow[0], renderer, Entries());
+
+    auto out = renderer.writeBorder(buffer);
+    auto next = m_rows.begin();
+    for (RowNumber r = 0; r < m_rowCount; ++r) {
+        if (next != m_rows.end() && next->first == r) {
+            out = writeRow(out, renderer, next->second);
+            ++next;
+        } else {
+            std::memcpy(out, emptyRow.data(), emptyRow.size());
+            out += emptyRow.size();
+        }
+        std::memcpy(out, border.data(), border.size());
+        out += border.size();
+    }
+    assert(out == buffer + size);
+
+    return size;
+}
+
+std::string SparseTextable::toString() const
+{
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size());
+    }
+    return result;
+}
+
+std::ostream &operator<<(std::ostream &os, const SparseTextable &table)
+{
+    if (table.m_rowCount == 0) {
+        return os;
+    }
+
+    const Renderer renderer(table.columnWidths());
+    const auto &border = renderer.border();
+
+    std::string emptyRow(renderer.lineSize(), ' ');
+    table.writeRow(&emptyRow[0], renderer, SparseTextable::Entries());
+
+    // A single buffer for all occupied rows.
+    std::string buffer;
+
+    os.write(border.data(), border.size());
+    auto next = table.m_rows.begin();
+    for (SparseTextable::RowNumber r = 0; r < table.m_rowCount; ++r) {
+        if (next != table.m_rows.end() && next->first == r) {
+            buffer.resize(table.rowSize(next->second, renderer.lineSize()));
+            table.writeRow(&buffer[0], renderer, next->second);
+            os.write(buffer.data(), buffer.size());
+            ++next;
+        } else {
+            os.write(emptyRow.data(), emptyRow.size());
+        }
+        os.write(border.data(), border.size());
+    }
+    return os;
+}
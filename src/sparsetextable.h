@@ -0,0 +1,200 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __SPARSETEXTABLE_H__
+#define __SPARSETEXTABLE_H__
+
+#include "textable.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+class Renderer;
+
+//! Implements a text table that stores only the occupied cells.
+/*!
+    `Textable` stores all rows up to the last one and all cells of a row up to the
+    last one, even if they are empty. This table keeps a row indexed map of the
+    occupied cells instead, so that a single cell far from the origin costs as much as
+    any other cell. The empty rows and cells are rendered procedurally.
+
+    The output format is the same as the `Textable` one, byte for byte.
+*/
+class TEXTABLE_EXPORT SparseTextable
+{
+public:
+    using Align        = Textable::Align;
+    using RowNumber    = Textable::RowNumber;
+    using ColumnNumber = Textable::ColumnNumber;
+
+    //! Sets a value to the cell referred by the given \p row and \p column.
+    /*!
+        The value is converted to the text as `Textable::setCell()` does.
+    */
+    template<typename T>
+    void setCell(RowNumber row, ColumnNumber column, Align align, T && value);
+
+    //! Sets the values of the \p rowData container to the given \p row.
+    /*!
+        The row is replaced with the values, starting from the first column.
+    */
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setRow(RowNumber row, Align align, T && rowData);
+
+    //! Sets the values to the given \p row, starting from the first column.
+    template<typename Value, typename... Ts>
+    void setRow(RowNumber row, Align align, Value && value, Ts &&... restValues);
+
+    //! Sets the values of the \p columnData container to the given \p column, starting from the first row.
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setColumn(ColumnNumber column, Align align, T && columnData);
+
+    //! Returns the number of rows of the table.
+    RowNumber rowCount() const;
+
+    //! Returns the number of columns of the table.
+    ColumnNumber columnCount() const;
+
+    //! Returns the number of the stored cells.
+    size_t cellCount() const;
+
+    //! Returns the text of the cell referred by the given \p row and \p column.
+    /*!
+        Returns an empty string if the cell is not set.
+    */
+    std::string cellData(RowNumber row, ColumnNumber column) const;
+
+    //! Returns the content widths of the columns, excluding the cell padding.
+    std::vector<size_t> columnWidths() const;
+
+    //! Returns the size of the rendered table in bytes.
+    size_t renderedSize() const;
+
+    //! Renders the table into the \p buffer of the given \p capacity.
+    /*!
+        \returns Returns the size of the rendered table. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Returns the string representation of the table.
+    std::string toString() const;
+
+    friend TEXTABLE_EXPORT std::ostream &operator<<(std::ostream &os, const SparseTextable &table);
+
+private:
+    /// An occupied cell of a row.
+    struct Entry
+    {
+        ColumnNumber m_column;
+        Textable::CellData m_cell;
+    };
+
+    /// The occupied cells of a row, in the column order.
+    using Entries = std::vector<Entry>;
+
+    /// Holds the width of a column.
+    struct ColumnWidth
+    {
+        size_t m_width = 0;     ///< The widest cell width.
+        RowNumber m_count = 0;  ///< The number of cells that have the widest width.
+    };
+
+    /// Stores the \p text to the cell referred by the given \p row and \p column.
+    void storeCell(RowNumber row, ColumnNumber column, Align align, std::string && text);
+
+    /// Removes all cells of the given \p row.
+    void clearRow(RowNumber row);
+
+    /// Updates the row sizes histogram and the column count after a row resize.
+    void updateRowSize(ColumnNumber oldSize, ColumnNumber newSize);
+
+    /// Updates the \p column width after a cell of the column changed its width.
+    void updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth);
+
+    /// Writes the \p entries row line into \p out and returns the end of the written data.
+    char *writeRow(char *out, const Renderer &renderer, const Entries &entries) const;
+
+    /// Returns the size of the rendered \p entries row line in bytes.
+    size_t rowSize(const Entries &entries, size_t lineSize) const;
+
+    std::map<RowNumber, Entries> m_rows;
+
+    /// The number of rows per row size, i.e. per the last occupied column plus one.
+    std::map<ColumnNumber, RowNumber> m_rowSizes;
+
+    std::vector<ColumnWidth> m_columnWidths;
+
+    /// The number of bytes all cells take in excess of their display width.
+    size_t m_extraSize = 0;
+
+    size_t m_cellCount = 0;
+
+    /// The number of rows. Rows may have no cells.
+    RowNumber m_rowCount = 0;
+};
+
+template<typename T>
+void SparseTextable::setCell(RowNumber row, ColumnNumber column, Align align, T && value)
+{
+    storeCell(row, column, align, Textable::valueToString(std::forward<T>(value)));
+}
+
+template<typename T, typename U, typename>
+void SparseTextable::setRow(RowNumber row, Align align, T && rowData)
+{
+    clearRow(row);
+    m_rowCount = std::max(m_rowCount, row + 1);
+
+    ColumnNumber column = 0;
+    for (auto &&value : rowData) {
+        storeCell(row, column++, align, Textable::valueToString(Textable::forwardElement<T>(value)));
+    }
+}
+
+template<typename Value, typename... Ts>
+void SparseTextable::setRow(RowNumber row, Align align, Value && value, Ts &&... restValues)
+{
+    ColumnNumber column = 0;
+    setCell(row, column++, align, std::forward<Value>(value));
+    const int expand[] = { 0, (setCell(row, column++, align, std::forward<Ts>(restValues)), 0)... };
+    (void)expand;
+}
+
+template<typename T, typename U, typename>
+void SparseTextable::setColumn(ColumnNumber column, Align align, T && columnData)
+{
+    RowNumber row = 0;
+    for (auto &&value : columnData) {
+        storeCell(row++, column, align, Textable::valueToString(Textable::forwardElement<T>(value)));
+    }
+}
+
+#endif // !__SPARSETEXTABLE_H__
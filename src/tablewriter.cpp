@@ -0,0 +1,221 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "tablewriter.h"
+#include "renderer.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#if defined(_WIN32)
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
+TableWriter::TableWriter(std::ostream &stream)
+    :
+        TableWriter(stream, Options{})
+{}
+
+TableWriter::TableWriter(std::ostream &stream, Options options)
+    :
+        m_options(std::move(options)),
+        m_stream(&stream)
+{
+    m_fixed = m_options.m_mode == Mode::Fixed;
+    m_options.m_batchSize = std::max<size_t>(m_options.m_batchSize, 1);
+}
+
+TableWriter::TableWriter(int fileDescriptor)
+    :
+        TableWriter(fileDescriptor, Options{})
+{}
+
+TableWriter::TableWriter(int fileDescriptor, Options options)
+    :
+        m_options(std::move(options)),
+        m_fileDescriptor(fileDescriptor)
+{
+    m_fixed = m_options.m_mode == Mode::Fixed;
+    m_options.m_batchSize = std::max<size_t>(m_options.m_batchSize, 1);
+}
+
+TableWriter::~TableWriter()
+{
+    flush();
+}
+
+void TableWriter::appendCells(Textable::Row &, Textable::Align)
+{
+    // Do nothing.
+}
+
+void TableWriter::addRow(Textable::Row row)
+{
+    for (auto &cell : row) {
+        cell.m_width = Unicode::displayWidth(cell.m_data);
+    }
+    ++m_rowCount;
+
+    if (m_fixed) {
+        writeRows(&row, 1);
+        return;
+    }
+
+    m_pending.emplace_back(std::move(row));
+    if (m_pending.size() >= m_options.m_batchSize) {
+        flush();
+    }
+}
+
+void TableWriter::flush()
+{
+    if (m_pending.empty()) {
+        return;
+    }
+
+    // Derive the column widths from the pending rows.
+    auto &widths = m_options.m_widths;
+    for (const auto &row : m_pending) {
+        if (row.size() > widths.size()) {
+            widths.resize(row.size());
+        }
+        for (Textable::ColumnNumber c = 0; c < row.size(); ++c) {
+            widths[c] = std::max(widths[c], row[c].m_width);
+        }
+    }
+
+    if (m_options.m_mode == Mode::FirstBatch) {
+        m_fixed = true;
+    }
+
+    writeRows(m_pending.data(), m_pending.size());
+    m_pending.clear();
+
+    if (m_stream) {
+        m_stream->flush();
+    }
+}
+
+void TableWriter::writeRows(Textable::Row *rows, size_t count)
+{
+    const Renderer renderer(m_options.m_widths);
+
+    if (!m_started) {
+        write(renderer.border().data(), renderer.border().size());
+        m_started = true;
+    }
+
+    for (size_t r = 0; r < count; ++r) {
+        auto &row = rows[r];
+        fitRow(row);
+
+        const auto size = renderer.rowSize(row);
+        if (size > m_buffer.size()) {
+            m_buffer.resize(size);
+        }
+        renderer.writeRow(&m_buffer[0], row);
+        write(m_buffer.data(), size);
+        write(renderer.border().data(), renderer.border().size());
+    }
+}
+
+void TableWriter::fitRow(Textable::Row &row) const
+{
+    const auto &widths = m_options.m_widths;
+    if (row.size() > widths.size()) {
+        row.resize(widths.size());
+    }
+
+    for (Textable::ColumnNumber c = 0; c < row.size(); ++c) {
+        auto &cell = row[c];
+        const auto maxWidth = widths[c];
+        if (cell.m_width <= maxWidth) {
+            continue;
+        }
+
+        // Truncate the cell leaving room for the ellipsis, if it fits at all.
+        const auto &ellipsis = m_options.m_ellipsis;
+        const auto ellipsisWidth = Unicode::displayWidth(ellipsis);
+        const bool withEllipsis = ellipsisWidth <= maxWidth;
+
+        size_t width = 0;
+        const auto size = Unicode::prefixSize(cell.m_data.data(), cell.m_data.size(),
+                                              maxWidth - (withEllipsis ? ellipsisWidth : 0), width);
+        cell.m_data.resize(size);
+        if (withEllipsis) {
+            cell.m_data += ellipsis;
+            width += ellipsisWidth;
+        }
+        cell.m_width = width;
+    }
+}
+
+void TableWriter::write(const char *data, size_t size)
+{
+    if (!m_good) {
+        return;
+    }
+
+    if (m_stream) {
+        m_stream->write(data, static_cast<std::streamsize>(size));
+        m_good = m_stream->good();
+        return;
+    }
+
+    while (size > 0) {
+#if defined(_WIN32)
+        const auto written = ::_write(m_fileDescriptor, data, static_cast<unsigned>(size));
+#else
+        const auto written = ::write(m_fileDescriptor, data, size);
+#endif
+        if (written < 0 && errno == EINTR) {
+            // Interrupted by a signal before writing anything.
+            continue;
+        }
+        if (written <= 0) {
+            m_good = false;
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+Textable::RowNumber TableWriter::rowCount() const
+{
+    return m_rowCount;
+}
+
+const std::vector<size_t> &TableWriter::columnWidths() const
+{
+    return m_options.m_widths;
+}
+
+bool TableWriter::good() const
+{
+    return m_good;
+}
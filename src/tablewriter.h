@@ -0,0 +1,209 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __TABLEWRITER_H__
+#define __TABLEWRITER_H__
+
+#include "textable.h"
+
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//! Implements a streaming writer of text tables.
+/*!
+    Unlike `Textable`, which needs all rows before it can be rendered, the writer
+    accepts rows one at a time and writes them to an output stream or a file descriptor
+    as soon as the column widths are known. The memory use is bounded by the size of the
+    look-ahead window, not by the number of rows.
+
+    The column widths are defined by the writer mode:
+    - `Mode::Fixed` - the widths are declared up front, rows are written immediately;
+    - `Mode::FirstBatch` - the widths are derived from the first batch of rows and
+      fixed afterwards;
+    - `Mode::Window` - the widths are derived from each batch of rows. The widths never
+      shrink, but may grow from one batch to another.
+
+    In the `Fixed` and `FirstBatch` modes cells that are wider than their column are
+    truncated and end with the ellipsis, and cells beyond the last column are dropped.
+
+    When the column widths match, the output is byte-identical to the `Textable` output
+    for the same rows. The output is a complete table after each written row.
+
+    \example
+        TableWriter::Options options;
+        options.m_batchSize = 100;
+        TableWriter writer(std::cout, options);
+        for (const auto &record : records) {
+            writer.addRow(Textable::Align::Left, record.m_name, record.m_value);
+        }
+*/
+class TEXTABLE_EXPORT TableWriter
+{
+public:
+    /// Defines how the column widths are determined.
+    enum class Mode
+    {
+        Fixed,      ///< The widths are declared up front.
+        FirstBatch, ///< The widths are derived from the first batch of rows.
+        Window      ///< The widths are derived from each batch of rows and can grow.
+    };
+
+    /// Defines the writer options.
+    struct Options
+    {
+        Mode m_mode = Mode::FirstBatch;
+
+        /// The column content widths. Mandatory for the `Fixed` mode, and the minimal
+        /// widths for the other modes.
+        std::vector<size_t> m_widths;
+
+        /// The number of rows in the look-ahead window.
+        size_t m_batchSize = 1000;
+
+        /// The ending of truncated cells, U+2026 in UTF-8 by default.
+        std::string m_ellipsis = "\xE2\x80\xA6";
+    };
+
+    //! Constructs a writer with the default options that writes to the given output \p stream.
+    explicit TableWriter(std::ostream &stream);
+
+    //! Constructs a writer that writes to the given output \p stream.
+    TableWriter(std::ostream &stream, Options options);
+
+    //! Constructs a writer with the default options that writes to the given file descriptor.
+    /*!
+        The writer doesn't own the descriptor.
+    */
+    explicit TableWriter(int fileDescriptor);
+
+    //! Constructs a writer that writes to the given file descriptor.
+    /*!
+        The writer doesn't own the descriptor.
+    */
+    TableWriter(int fileDescriptor, Options options);
+
+    //! Destroys the writer and writes all pending rows.
+    ~TableWriter();
+
+    TableWriter(const TableWriter &) = delete;
+    TableWriter &operator=(const TableWriter &) = delete;
+
+    //! Adds a row of the given cells.
+    void addRow(Textable::Row row);
+
+    //! Adds a row with the values of the given container.
+    /*!
+        \param align   The cell texts alignment - common for the whole row.
+        \param rowData A container whose elements should be convertible to string.
+    */
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void addRow(Textable::Align align, T && rowData);
+
+    //! Adds a row with values of arbitrary types.
+    /*!
+        \param align The cell texts alignment - common for the whole row.
+    */
+    template<typename Value, typename... Ts>
+    void addRow(Textable::Align align, Value && value, Ts &&... restValues);
+
+    //! Writes all pending rows.
+    /*!
+        In the `FirstBatch` mode this fixes the column widths even if the first
+        batch is not complete yet.
+    */
+    void flush();
+
+    //! Returns the number of added rows.
+    Textable::RowNumber rowCount() const;
+
+    //! Returns the current column content widths.
+    const std::vector<size_t> &columnWidths() const;
+
+    //! Returns false if writing to the output has failed.
+    bool good() const;
+
+private:
+    template<typename Value, typename... Ts>
+    static void appendCells(Textable::Row &row, Textable::Align align, Value && value, Ts &&... restValues);
+
+    static void appendCells(Textable::Row &, Textable::Align);
+
+    /// Writes the given rows with the current widths.
+    void writeRows(Textable::Row *rows, size_t count);
+
+    /// Fits the \p row to the fixed column widths.
+    void fitRow(Textable::Row &row) const;
+
+    /// Writes the given data to the output.
+    void write(const char *data, size_t size);
+
+    Options m_options;
+    std::ostream *m_stream = nullptr;
+    int m_fileDescriptor = -1;
+    bool m_good = true;
+
+    /// Whether the column widths are fixed.
+    bool m_fixed = false;
+    /// Whether the top border is already written.
+    bool m_started = false;
+
+    std::vector<Textable::Row> m_pending;
+    std::string m_buffer;
+    Textable::RowNumber m_rowCount = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Definition of the function templates
+
+template<typename T, typename U, typename>
+void TableWriter::addRow(Textable::Align align, T && rowData)
+{
+    Textable::Row row;
+    row.reserve(rowData.size());
+    for (auto &&value : rowData) {
+        row.emplace_back(Textable::valueToString(Textable::forwardElement<T>(value)), align);
+    }
+    addRow(std::move(row));
+}
+
+template<typename Value, typename... Ts>
+void TableWriter::addRow(Textable::Align align, Value && value, Ts &&... restValues)
+{
+    Textable::Row row;
+    row.reserve(1 + sizeof...(restValues));
+    appendCells(row, align, std::forward<Value>(value), std::forward<Ts>(restValues)...);
+    addRow(std::move(row));
+}
+
+template<typename Value, typename... Ts>
+void TableWriter::appendCells(Textable::Row &row, Textable::Align align, Value && value, Ts &&... restValues)
+{
+    row.emplace_back(Textable::valueToString(std::forward<Value>(value)), align);
+    appendCells(row, align, std::forward<Ts>(restValues)...);
+}
+
+#endif // !__TABLEWRITER_H__
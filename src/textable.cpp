@@ -23,22 +23,337 @@
 ***********************************************************************************/
 
 #include "textable.h"
+#include "parallel.h"
+#include "renderer.h"
+#include "unicode.h"
 
 #include <algorithm>
-#include <sstream>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+namespace
+{
+
+/// Returns the maximal content width of the column of the given \p format, or zero.
+size_t widthLimit(const Textable::ColumnFormat &format)
+{
+    return format.m_maxWidth > 0 ? std::max<size_t>(format.m_maxWidth, 2) : 0;
+}
+
+} // namespace
+
+Textable::Textable(MemoryPool &pool)
+    :
+        m_pool(&pool)
+{
+    m_table.swap(pool.m_table);
+    m_rowSizes.swap(pool.m_rowSizes);
+    m_columnWidths.swap(pool.m_columnWidths);
+}
+
+Textable::~Textable()
+{
+    // Nothing to give back for the moved from tables.
+    if (!m_pool || m_table.capacity() == 0) {
+        return;
+    }
+
+    // Keeping the memory is an optimization only, so give up if it fails.
+    try {
+        clear();
+        auto &pool = *m_pool;
+        if (m_table.capacity() > pool.m_table.capacity()) {
+            pool.m_table.swap(m_table);
+        }
+        if (m_rowSizes.capacity() > pool.m_rowSizes.capacity()) {
+            pool.m_rowSizes.swap(m_rowSizes);
+        }
+        if (m_columnWidths.capacity() > pool.m_columnWidths.capacity()) {
+            pool.m_columnWidths.swap(m_columnWidths);
+        }
+    } catch (const std::bad_alloc &) {
+    }
+}
 
 size_t Textable::stringSize(const std::string &string)
 {
-#if defined (_MSC_VER)
-    size_t size = 0;
-    if (mbstowcs_s(&size, NULL, 0, string.c_str(), 0) == 0) {
-        size--; // Consider the null-terminator too.
+    return Unicode::displayWidth(string);
+}
+
+std::string Textable::signedToString(long long value)
+{
+    if (value >= 0) {
+        return unsignedToString(static_cast<unsigned long long>(value));
     }
-    return size;
-#else
-    return std::mbstowcs(NULL, string.c_str(), string.size());
-#endif
+    // Negate in the unsigned domain to handle the minimal value too.
+    auto result = unsignedToString(0ULL - static_cast<unsigned long long>(value));
+    result.insert(result.begin(), '-');
+    return result;
+}
+
+std::string Textable::unsignedToString(unsigned long long value)
+{
+    char buffer[24];
+    auto end = buffer + sizeof(buffer);
+    auto begin = end;
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return std::string(begin, end);
+}
+
+namespace
+{
+
+/// Replaces the locale specific decimal point of the printf() output with '.'.
+/*!
+    The "%g" format produces only digits, signs, exponent and "inf"/"nan" letters
+    besides the decimal point, so the decimal point is the only run of other bytes.
+*/
+std::string fixDecimalPoint(const char *data, int size)
+{
+    std::string result(data, static_cast<size_t>(size));
+    for (size_t i = 0; i < result.size(); ++i) {
+        const auto c = result[i];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+            (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            continue;
+        }
+        auto end = i + 1;
+        while (end < result.size() && !(result[end] >= '0' && result[end] <= '9')) {
+            ++end;
+        }
+        result.replace(i, end - i, 1, '.');
+        break;
+    }
+    return result;
+}
+
+} // namespace
+
+std::string Textable::floatingToString(double value)
+{
+    // The default std::ostream floating point format.
+    char buffer[32];
+    const auto size = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return fixDecimalPoint(buffer, size);
+}
+
+std::string Textable::floatingToString(long double value)
+{
+    char buffer[64];
+    const auto size = std::snprintf(buffer, sizeof(buffer), "%Lg", value);
+    return fixDecimalPoint(buffer, size);
+}
+
+namespace
+{
+
+/// Inserts the thousands \p separator into the leading integer digits of the \p number.
+void insertThousandsSeparator(std::string &number, char separator)
+{
+    size_t begin = 0;
+    if (!number.empty() && (number[0] == '-' || number[0] == '+')) {
+        begin = 1;
+    }
+    auto end = begin;
+    while (end < number.size() && number[end] >= '0' && number[end] <= '9') {
+        ++end;
+    }
+
+    for (auto position = end; position > begin + 3; position -= 3) {
+        number.insert(position - 3, 1, separator);
+    }
+}
+
+} // namespace
+
+std::string Textable::formatNumber(long long value, const ColumnFormat &format)
+{
+    if (format.m_notation != ColumnFormat::Notation::General) {
+        return formatNumber(static_cast<long double>(value), format);
+    }
+    auto result = signedToString(value);
+    if (format.m_thousandsSeparator) {
+        insertThousandsSeparator(result, format.m_thousandsSeparator);
+    }
+    return result;
+}
+
+std::string Textable::formatNumber(unsigned long long value, const ColumnFormat &format)
+{
+    if (format.m_notation != ColumnFormat::Notation::General) {
+        return formatNumber(static_cast<long double>(value), format);
+    }
+    auto result = unsignedToString(value);
+    if (format.m_thousandsSeparator) {
+        insertThousandsSeparator(result, format.m_thousandsSeparator);
+    }
+    return result;
+}
+
+std::string Textable::formatNumber(long double value, const ColumnFormat &format)
+{
+    const char *pattern = "%.*Lg";
+    if (format.m_notation == ColumnFormat::Notation::Fixed) {
+        pattern = "%.*Lf";
+    } else if (format.m_notation == ColumnFormat::Notation::Scientific) {
+        pattern = "%.*Le";
+    }
+    const auto precision = format.m_precision < 0 ? 6 : format.m_precision;
+
+    char buffer[128];
+    auto size = std::snprintf(buffer, sizeof(buffer), pattern, precision, value);
+    std::string result;
+    if (size >= 0 && static_cast<size_t>(size) < sizeof(buffer)) {
+        result = fixDecimalPoint(buffer, size);
+    } else {
+        // Very large fixed point numbers or precisions.
+        std::string large(static_cast<size_t>(std::max(size, 0)) + 1, '\0');
+        size = std::snprintf(&large[0], large.size(), pattern, precision, value);
+        result = fixDecimalPoint(large.data(), size);
+    }
+
+    if (format.m_thousandsSeparator) {
+        insertThousandsSeparator(result, format.m_thousandsSeparator);
+    }
+    return result;
+}
+
+void Textable::setColumnFormat(ColumnNumber column, const ColumnFormat &format)
+{
+    auto &columnFormat = m_formats[column];
+    const bool relayout = widthLimit(columnFormat) != widthLimit(format) ||
+                          (format.m_maxWidth > 0 && columnFormat.m_overflow != format.m_overflow);
+    columnFormat = format;
+    ++m_generation;
+
+    if (relayout) {
+        m_hasMaxWidths = std::any_of(m_formats.begin(), m_formats.end(),
+                                     [](const std::pair<const ColumnNumber, ColumnFormat> &columnFormat) {
+                                         return columnFormat.second.m_maxWidth > 0;
+                                     });
+        for (RowNumber r = 0; r < m_table.size(); ++r) {
+            if (column < m_table[r].size()) {
+                auto &cell = m_table[r][column];
+                releaseCellLines(cell);
+                updateCellLines(cell, column);
+                markChanged(r);
+            }
+        }
+    }
+}
+
+bool Textable::breakCell(const CellData &cell, const ColumnFormat &format, CellLines &lines)
+{
+    const auto limit = widthLimit(format);
+    const auto &text = cell.m_data;
+    const bool wrap = format.m_overflow == ColumnFormat::Overflow::Wrap;
+    if (limit == 0 || (cell.m_width <= limit && (!wrap || text.find('\n') == std::string::npos))) {
+        return false;
+    }
+
+    lines.m_lines.clear();
+    lines.m_ellipsis = !wrap;
+    if (!wrap) {
+        // Leave room for the one column wide ellipsis.
+        size_t width = 0;
+        const auto size = Unicode::prefixSize(text.data(), text.size(), limit - 1, width);
+        lines.m_lines.push_back({ 0, size, width });
+        return true;
+    }
+
+    const auto data = text.data();
+    size_t begin = 0;
+    while (true) {
+        // Wrap each paragraph separately.
+        auto end = text.find('\n', begin);
+        const auto last = end == std::string::npos;
+        if (last) {
+            end = text.size();
+        }
+        const auto next = end + 1;
+        if (end > begin && data[end - 1] == '\r') {
+            --end;
+        }
+
+        do {
+            size_t width = 0;
+            auto size = Unicode::prefixSize(data + begin, end - begin, limit, width);
+            assert(size > 0 || begin == end);
+            if (begin + size < end) {
+                // Break at the last space that fits, if any, or within the word.
+                auto space = begin + size;
+                while (space > begin && data[space] != ' ') {
+                    --space;
+                }
+                if (space > begin) {
+                    size = space - begin;
+                    width = Unicode::displayWidth(data + begin, size);
+                }
+            }
+            lines.m_lines.push_back({ begin, size, width });
+            begin += size;
+            while (begin < end && data[begin] == ' ') {
+                ++begin;
+            }
+        } while (begin < end);
+
+        if (last) {
+            break;
+        }
+        begin = next;
+    }
+    return true;
+}
+
+void Textable::updateCellLines(CellData &cell, ColumnNumber column)
+{
+    assert(cell.m_lines == 0);
+    if (!m_hasMaxWidths) {
+        return;
+    }
+    const auto format = m_formats.find(column);
+    if (format == m_formats.end()) {
+        return;
+    }
+
+    CellLines lines;
+    if (!breakCell(cell, format->second, lines)) {
+        return;
+    }
+    if (m_freeCellLines.empty()) {
+        m_cellLines.push_back(std::move(lines));
+        cell.m_lines = static_cast<uint32_t>(m_cellLines.size());
+    } else {
+        const auto index = m_freeCellLines.back();
+        m_freeCellLines.pop_back();
+        m_cellLines[index] = std::move(lines);
+        cell.m_lines = index + 1;
+    }
+}
+
+void Textable::releaseCellLines(CellData &cell)
+{
+    if (cell.m_lines == 0) {
+        return;
+    }
+    const auto index = cell.m_lines - 1;
+    m_cellLines[index] = CellLines();
+    m_freeCellLines.push_back(index);
+    cell.m_lines = 0;
+}
+
+const Textable::ColumnFormat *Textable::columnFormat(ColumnNumber column) const
+{
+    if (m_formats.empty()) {
+        return nullptr;
+    }
+    const auto it = m_formats.find(column);
+    return it != m_formats.end() ? &it->second : nullptr;
 }
 
 Textable::RowNumber Textable::rowCount() const
@@ -48,11 +363,372 @@ Textable::RowNumber Textable::rowCount() const
 
 Textable::ColumnNumber Textable::columnCount() const
 {
-    auto longestRow = std::max_element(m_table.cbegin(), m_table.cend(),
-                                       [](const Row &rowLeft, const Row &rowRight) {
-                                           return rowLeft.size() < rowRight.size();
-                                       });
-    return longestRow != m_table.cend() ? longestRow->size() : Textable::ColumnNumber{};
+    return m_columnCount;
+}
+
+void Textable::ensureRowCount(RowNumber count)
+{
+    if (count > m_table.size()) {
+        auto &spares = spareRows();
+        while (m_table.size() < count && !spares.empty()) {
+            m_table.push_back(std::move(spares.back()));
+            spares.pop_back();
+        }
+        m_table.resize(count);
+        ++m_generation;
+    }
+}
+
+Textable::Row &Textable::ensureCellCount(RowNumber row, ColumnNumber count)
+{
+    ensureRowCount(row + 1);
+
+    auto &rowObj = m_table[row];
+    if (count > rowObj.size()) {
+        const auto oldSize = rowObj.size();
+        if (count > rowObj.capacity()) {
+            // Grow geometrically, so that filling a row cell by cell is not quadratic.
+            rowObj.reserve(std::max({ count, m_reservedColumns, 2 * rowObj.capacity() }));
+        }
+        rowObj.resize(count);
+        updateRowSize(oldSize, count);
+    }
+    return rowObj;
+}
+
+void Textable::setCell(RowNumber row, ColumnNumber column, Align align, const char *data, size_t size)
+{
+    ensureCellCount(row, column + 1);
+    storeCell(row, column, {copyText(data, size), align});
+}
+
+std::string Textable::cellText(const std::string &value, ColumnNumber)
+{
+    return copyText(value.data(), value.size());
+}
+
+std::string Textable::cellText(std::string &value, ColumnNumber)
+{
+    return copyText(value.data(), value.size());
+}
+
+std::string Textable::cellText(const char *value, ColumnNumber)
+{
+    return value ? copyText(value, std::strlen(value)) : std::string{};
+}
+
+std::string Textable::copyText(const char *data, size_t size)
+{
+    // Short strings don't allocate anyway.
+    static const auto shortCapacity = std::string().capacity();
+    auto &spares = spareStrings();
+    if (size <= shortCapacity || spares.empty()) {
+        return std::string(data, size);
+    }
+
+    auto text = std::move(spares.back());
+    spares.pop_back();
+    text.assign(data, size);
+    return text;
+}
+
+Textable::Row Textable::takeRow()
+{
+    auto &spares = spareRows();
+    if (spares.empty()) {
+        return {};
+    }
+    auto row = std::move(spares.back());
+    spares.pop_back();
+    return row;
+}
+
+void Textable::recycleRow(Row &&row)
+{
+    static const auto shortCapacity = std::string().capacity();
+    for (auto cell = row.rbegin(); cell != row.rend(); ++cell) {
+        if (cell->m_data.capacity() > shortCapacity) {
+            cell->m_data.clear();
+            spareStrings().push_back(std::move(cell->m_data));
+        }
+    }
+    if (row.capacity() > 0) {
+        row.clear();
+        spareRows().push_back(std::move(row));
+    }
+}
+
+std::vector<Textable::Row> &Textable::spareRows()
+{
+    return m_pool ? m_pool->m_rows : m_spareRows;
+}
+
+std::vector<std::string> &Textable::spareStrings()
+{
+    return m_pool ? m_pool->m_strings : m_spareStrings;
+}
+
+void Textable::clear()
+{
+    // Only the memory of the last table is kept, so that the spares don't grow
+    // with the moved in strings and rows.
+    spareRows().clear();
+    spareStrings().clear();
+
+    // The spares are taken from the back, so that populating the table in the same order
+    // reuses the memory of the same rows and cells.
+    for (auto row = m_table.rbegin(); row != m_table.rend(); ++row) {
+        recycleRow(std::move(*row));
+    }
+    m_table.clear();
+
+    m_columnCount = {};
+    m_rowSizes.clear();
+    m_columnWidths.clear();
+    m_cellLines.clear();
+    m_freeCellLines.clear();
+
+    ++m_generation;
+    m_changes.m_offsets.clear();
+    m_changes.m_flags.clear();
+    m_changes.m_rows.clear();
+}
+
+void Textable::reserve(RowNumber rows, ColumnNumber columns)
+{
+    m_table.reserve(rows);
+    m_reservedColumns = columns;
+    if (columns > m_columnWidths.size()) {
+        m_columnWidths.resize(columns);
+    }
+    if (columns >= m_rowSizes.size()) {
+        m_rowSizes.resize(columns + 1);
+    }
+}
+
+void Textable::appendRow(Row row)
+{
+    m_table.emplace_back();
+    replaceRow(m_table.size() - 1, std::move(row));
+}
+
+void Textable::splice(Textable &&other)
+{
+    if (&other == this || other.m_table.empty()) {
+        return;
+    }
+
+    ++m_generation;
+    const auto firstRow = m_table.size();
+    if (m_table.empty() && m_table.capacity() < other.m_table.size()) {
+        m_table = std::move(other.m_table);
+    } else {
+        m_table.insert(m_table.end(), std::make_move_iterator(other.m_table.begin()),
+                       std::make_move_iterator(other.m_table.end()));
+    }
+
+    // Merge the row sizes histograms and the column widths.
+    if (other.m_rowSizes.size() > m_rowSizes.size()) {
+        m_rowSizes.resize(other.m_rowSizes.size());
+    }
+    for (size_t size = 0; size < other.m_rowSizes.size(); ++size) {
+        m_rowSizes[size] += other.m_rowSizes[size];
+    }
+    m_columnCount = std::max(m_columnCount, other.m_columnCount);
+
+    if (other.m_columnWidths.size() > m_columnWidths.size()) {
+        m_columnWidths.resize(other.m_columnWidths.size());
+    }
+    for (ColumnNumber c = 0; c < other.m_columnWidths.size(); ++c) {
+        auto &columnWidth = m_columnWidths[c];
+        const auto &otherWidth = other.m_columnWidths[c];
+        if (otherWidth.m_width > columnWidth.m_width) {
+            columnWidth = otherWidth;
+        } else if (otherWidth.m_width == columnWidth.m_width) {
+            columnWidth.m_count += otherWidth.m_count;
+        }
+    }
+
+    // The own formats win. The width limits taken from the other table apply to the own
+    // rows as well, so lay their cells out again.
+    std::vector<ColumnNumber> limitedColumns;
+    for (const auto &format : other.m_formats) {
+        if (m_formats.insert(format).second && widthLimit(format.second) > 0) {
+            limitedColumns.push_back(format.first);
+        }
+    }
+    m_hasMaxWidths = m_hasMaxWidths || !limitedColumns.empty();
+    for (RowNumber r = 0; r < firstRow && !limitedColumns.empty(); ++r) {
+        auto &row = m_table[r];
+        for (auto column : limitedColumns) {
+            if (column < row.size()) {
+                releaseCellLines(row[column]);
+                updateCellLines(row[column], column);
+                markChanged(r);
+            }
+        }
+    }
+
+    // The lines of the moved cells refer to the other table, and the formats may differ.
+    if (m_hasMaxWidths || !other.m_cellLines.empty()) {
+        for (auto r = firstRow; r < m_table.size(); ++r) {
+            auto &row = m_table[r];
+            for (ColumnNumber c = 0; c < row.size(); ++c) {
+                row[c].m_lines = 0;
+                updateCellLines(row[c], c);
+            }
+        }
+    }
+
+    const auto pool = other.m_pool;
+    other = Textable();
+    other.m_pool = pool;
+}
+
+void Textable::replaceRow(RowNumber row, Row &&newRow)
+{
+    assert(row < m_table.size());
+
+    for (auto &cell : newRow) {
+        cell.m_width = stringSize(cell.m_data);
+        cell.m_lines = 0;
+    }
+
+    ++m_generation;
+    markChanged(row);
+
+    auto &rowObj = m_table[row];
+    auto oldRow = std::move(rowObj);
+    rowObj = std::move(newRow);
+    updateRowSize(oldRow.size(), rowObj.size());
+
+    if (!m_cellLines.empty()) {
+        for (auto &cell : oldRow) {
+            releaseCellLines(cell);
+        }
+    }
+    if (m_hasMaxWidths) {
+        for (ColumnNumber c = 0; c < rowObj.size(); ++c) {
+            updateCellLines(rowObj[c], c);
+        }
+    }
+
+    const auto size = std::max(oldRow.size(), rowObj.size());
+    for (ColumnNumber c = 0; c < size; ++c) {
+        updateColumnWidth(c, c < oldRow.size() ? oldRow[c].m_width : 0,
+                             c < rowObj.size() ? rowObj[c].m_width : 0);
+    }
+
+    // The placeholder rows may come from the cleared rows, keep them. The replaced
+    // rows are freed, so that overwriting rows doesn't grow the spare rows.
+    if (oldRow.empty()) {
+        recycleRow(std::move(oldRow));
+    }
+}
+
+void Textable::storeCell(RowNumber row, ColumnNumber column, CellData &&cell)
+{
+    assert(row < m_table.size() && column < m_table[row].size());
+
+    ++m_generation;
+    markChanged(row);
+
+    auto &cellObj = m_table[row][column];
+    const auto oldWidth = cellObj.m_width;
+    releaseCellLines(cellObj);
+    cellObj = std::move(cell);
+    cellObj.m_width = stringSize(cellObj.m_data);
+    cellObj.m_lines = 0;
+    updateCellLines(cellObj, column);
+    updateColumnWidth(column, oldWidth, cellObj.m_width);
+}
+
+void Textable::markChanged(RowNumber row)
+{
+    if (!m_changes.m_enabled) {
+        return;
+    }
+    if (row >= m_changes.m_flags.size()) {
+        m_changes.m_flags.resize(row + 1, false);
+    }
+    if (!m_changes.m_flags[row]) {
+        m_changes.m_flags[row] = true;
+        m_changes.m_rows.push_back(row);
+    }
+}
+
+void Textable::updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth)
+{
+    if (oldWidth == newWidth) {
+        return;
+    }
+
+    if (column >= m_columnWidths.size()) {
+        m_columnWidths.resize(column + 1);
+    }
+    auto &columnWidth = m_columnWidths[column];
+
+    if (newWidth > columnWidth.m_width) {
+        columnWidth.m_width = newWidth;
+        columnWidth.m_count = 1;
+    } else if (newWidth == columnWidth.m_width && newWidth > 0) {
+        ++columnWidth.m_count;
+    }
+
+    // Zero width cells are not counted as they can't shrink the column.
+    if (oldWidth == columnWidth.m_width && oldWidth > 0) {
+        assert(columnWidth.m_count > 0);
+        if (--columnWidth.m_count == 0) {
+            // The last widest cell has shrunk. Find the new width from the cached cell widths.
+            columnWidth = {};
+            for (const auto &rowObj : m_table) {
+                if (column < rowObj.size()) {
+                    const auto width = rowObj[column].m_width;
+                    if (width > columnWidth.m_width) {
+                        columnWidth.m_width = width;
+                        columnWidth.m_count = 1;
+                    } else if (width == columnWidth.m_width && width > 0) {
+                        ++columnWidth.m_count;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Textable::updateRowSize(ColumnNumber oldSize, ColumnNumber newSize)
+{
+    if (oldSize == newSize) {
+        return;
+    }
+    ++m_generation;
+
+    if (oldSize > 0) {
+        assert(oldSize < m_rowSizes.size() && m_rowSizes[oldSize] > 0);
+        --m_rowSizes[oldSize];
+    }
+
+    if (newSize > 0) {
+        if (newSize >= m_rowSizes.size()) {
+            m_rowSizes.resize(newSize + 1);
+        }
+        ++m_rowSizes[newSize];
+    }
+
+    if (newSize > m_columnCount) {
+        m_columnCount = newSize;
+        // Columns of empty cells never update their widths, but still need them.
+        if (m_columnWidths.size() < m_columnCount) {
+            m_columnWidths.resize(m_columnCount);
+        }
+    } else if (oldSize == m_columnCount) {
+        // The longest row has shrunk - find the next longest one. The cost of
+        // the lookup is bounded by the size of the shrunk row.
+        while (m_columnCount > 0 && m_rowSizes[m_columnCount] == 0) {
+            --m_columnCount;
+        }
+        m_rowSizes.resize(m_columnCount + 1);
+    }
 }
 
 std::string Textable::cellData(RowNumber row, ColumnNumber column) const
@@ -68,5 +744,361 @@ std::string Textable::cellData(RowNumber row, ColumnNumber column) const
 
 std::string Textable::toString() const
 {
-    return toString(*this);
+    return toString(1U);
+}
+
+std::string Textable::toString(unsigned threadCount) const
+{
+    if (m_renderCacheEnabled) {
+        return *cachedString(threadCount);
+    }
+
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size(), threadCount);
+    }
+    return result;
+}
+
+void Textable::setRenderCache(bool enabled)
+{
+    m_renderCacheEnabled = enabled;
+    if (!enabled) {
+        std::lock_guard<std::mutex> lock(m_renderCache.m_mutex);
+        m_renderCache.m_string.reset();
+    }
+}
+
+uint64_t Textable::generation() const
+{
+    return m_generation;
+}
+
+std::shared_ptr<const std::string> Textable::snapshot() const
+{
+    if (m_renderCacheEnabled) {
+        return cachedString(1U);
+    }
+
+    auto result = std::make_shared<std::string>(renderedSize(), '\0');
+    if (!result->empty()) {
+        renderTo(&(*result)[0], result->size());
+    }
+    return result;
+}
+
+std::shared_ptr<const std::string> Textable::cachedString(unsigned threadCount) const
+{
+    std::lock_guard<std::mutex> lock(m_renderCache.m_mutex);
+    if (!m_renderCache.m_string || m_renderCache.m_generation != m_generation) {
+        auto result = std::make_shared<std::string>(renderedSize(), '\0');
+        if (!result->empty()) {
+            renderTo(&(*result)[0], result->size(), threadCount);
+        }
+        m_renderCache.m_string = std::move(result);
+        m_renderCache.m_generation = m_generation;
+    }
+    return m_renderCache.m_string;
+}
+
+std::vector<size_t> Textable::columnWidths() const
+{
+    return makeRenderer().columnWidths();
+}
+
+Renderer Textable::makeRenderer() const
+{
+    std::vector<size_t> widths(m_columnCount);
+    for (ColumnNumber c = 0; c < m_columnCount; ++c) {
+        widths[c] = m_columnWidths[c].m_width;
+    }
+    return makeRenderer(std::move(widths), nullptr);
+}
+
+Renderer Textable::makeRenderer(const std::vector<RowNumber> &rows) const
+{
+    // The columns are kept, so that the columns of the views match the table ones.
+    std::vector<size_t> widths(m_columnCount);
+    for (auto r : rows) {
+        const auto &row = m_table[r];
+        for (ColumnNumber c = 0; c < row.size(); ++c) {
+            widths[c] = std::max(widths[c], row[c].m_width);
+        }
+    }
+    return makeRenderer(std::move(widths), &rows);
+}
+
+Renderer Textable::makeRenderer(std::vector<size_t> widths, const std::vector<RowNumber> *rows) const
+{
+    struct Decimal
+    {
+        ColumnNumber m_column;
+        size_t m_integerWidth;
+        size_t m_fractionWidth;
+    };
+    std::vector<Decimal> decimals;
+
+    for (const auto &columnFormat : m_formats) {
+        const auto column = columnFormat.first;
+        const auto &format = columnFormat.second;
+        if (column >= m_columnCount) {
+            break;
+        }
+        // The cells that don't fit are cut or wrapped to the limit.
+        if (const auto limit = widthLimit(format)) {
+            widths[column] = std::min(widths[column], limit);
+        }
+        widths[column] = std::max(widths[column], format.m_width);
+
+        if (format.m_decimalAlign) {
+            // Find the widest integer and fraction parts in a single pass over the column.
+            Decimal decimal{ column, 0, 0 };
+            auto measure = [&decimal, column](const Row &row) {
+                size_t integerWidth = 0;
+                size_t fractionWidth = 0;
+                if (column < row.size() && row[column].m_lines == 0 &&
+                    Renderer::numberParts(row[column].m_data.data(), row[column].m_data.size(),
+                                          integerWidth, fractionWidth)) {
+                    decimal.m_integerWidth = std::max(decimal.m_integerWidth, integerWidth);
+                    decimal.m_fractionWidth = std::max(decimal.m_fractionWidth, fractionWidth);
+                }
+            };
+            if (rows) {
+                for (auto r : *rows) {
+                    measure(m_table[r]);
+                }
+            } else {
+                for (const auto &row : m_table) {
+                    measure(row);
+                }
+            }
+            widths[column] = std::max(widths[column], decimal.m_integerWidth + decimal.m_fractionWidth);
+            decimals.push_back(decimal);
+        }
+    }
+
+    Renderer renderer(std::move(widths));
+    for (const auto &decimal : decimals) {
+        renderer.setDecimalAlign(decimal.m_column, decimal.m_integerWidth, decimal.m_fractionWidth);
+    }
+    if (!m_cellLines.empty()) {
+        renderer.setCellLines(&m_cellLines);
+    }
+    return renderer;
+}
+
+size_t Textable::renderedSize() const
+{
+    if (m_table.empty()) {
+        return 0;
+    }
+
+    const auto renderer = makeRenderer();
+    auto size = renderer.lineSize();
+    for (const auto &row : m_table) {
+        size += renderer.rowSize(row) + renderer.lineSize();
+    }
+    return size;
+}
+
+size_t Textable::renderTo(char *buffer, size_t capacity) const
+{
+    return renderTo(buffer, capacity, 1U);
+}
+
+size_t Textable::renderTo(char *buffer, size_t capacity, unsigned threadCount) const
+{
+    if (m_table.empty()) {
+        return 0;
+    }
+
+    // Not worth a thread below this number of rows.
+    static const size_t minRowsPerThread = 4096;
+
+    const auto renderer = makeRenderer();
+    const auto slices = parallel::sliceCount(m_table.size(), parallel::threadCount(threadCount),
+                                             minRowsPerThread);
+
+    // Find the size of each slice of rows, then the slices offsets.
+    std::vector<size_t> offsets(slices + 1, 0);
+    offsets[0] = renderer.lineSize();
+    parallel::forEachSlice(m_table.size(), slices, [&](unsigned slice, size_t begin, size_t end) {
+        size_t size = 0;
+        for (auto r = begin; r < end; ++r) {
+            size += renderer.rowSize(m_table[r]) + renderer.lineSize();
+        }
+        offsets[slice + 1] = size;
+    });
+    for (unsigned slice = 0; slice < slices; ++slice) {
+        offsets[slice + 1] += offsets[slice];
+    }
+
+    const auto size = offsets.back();
+    if (size > capacity) {
+        return size;
+    }
+
+    renderer.writeBorder(buffer);
+    parallel::forEachSlice(m_table.size(), slices, [&](unsigned slice, size_t begin, size_t end) {
+        auto out = buffer + offsets[slice];
+        for (auto r = begin; r < end; ++r) {
+            out = renderer.writeRow(out, m_table[r]);
+            out = renderer.writeBorder(out);
+        }
+        assert(out == buffer + offsets[slice + 1]);
+    });
+
+    return size;
+}
+
+Textable::WindowRange Textable::windowRange(const Window &window) const
+{
+    WindowRange range;
+    range.m_headerEnd = std::min(window.m_headerRows, m_table.size());
+    range.m_beginRow = std::min(window.m_beginRow, m_table.size());
+    if (range.m_beginRow < range.m_headerEnd) {
+        // The window starts within the header, so it has the header rows anyway.
+        range.m_headerEnd = 0;
+    }
+    range.m_endRow = std::max(std::min(window.m_endRow, m_table.size()), range.m_beginRow);
+    range.m_beginColumn = std::min(window.m_beginColumn, m_columnCount);
+    range.m_endColumn = std::max(std::min(window.m_endColumn, m_columnCount), range.m_beginColumn);
+    return range;
+}
+
+size_t Textable::renderedSize(const WindowRange &range, const Renderer &renderer) const
+{
+    if (range.m_headerEnd == 0 && range.m_beginRow == range.m_endRow) {
+        return 0;
+    }
+
+    auto size = renderer.lineSize();
+    auto addRows = [&](RowNumber begin, RowNumber end) {
+        for (auto r = begin; r < end; ++r) {
+            size += renderer.rowSize(m_table[r], range.m_beginColumn) + renderer.lineSize();
+        }
+    };
+    addRows(0, range.m_headerEnd);
+    addRows(range.m_beginRow, range.m_endRow);
+    return size;
+}
+
+size_t Textable::renderedSize(const Window &window) const
+{
+    const auto range = windowRange(window);
+    return renderedSize(range, makeRenderer().columns(range.m_beginColumn, range.m_endColumn));
+}
+
+size_t Textable::renderTo(char *buffer, size_t capacity, const Window &window) const
+{
+    const auto range = windowRange(window);
+    const auto renderer = makeRenderer().columns(range.m_beginColumn, range.m_endColumn);
+    const auto size = renderedSize(range, renderer);
+    if (size == 0 || size > capacity) {
+        return size;
+    }
+
+    auto out = renderer.writeBorder(buffer);
+    auto writeRows = [&](RowNumber begin, RowNumber end) {
+        for (auto r = begin; r < end; ++r) {
+            out = renderer.writeRow(out, m_table[r], range.m_beginColumn);
+            out = renderer.writeBorder(out);
+        }
+    };
+    writeRows(0, range.m_headerEnd);
+    writeRows(range.m_beginRow, range.m_endRow);
+    assert(out == buffer + size);
+
+    return size;
+}
+
+std::string Textable::toString(const Window &window) const
+{
+    std::string result(renderedSize(window), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size(), window);
+    }
+    return result;
+}
+
+std::vector<Textable::ByteRange> Textable::renderChanges(std::string &output)
+{
+    const auto renderer = makeRenderer();
+    auto &changes = m_changes;
+
+    // The rows can be patched in place only if the columns are the same and none of the rows moved.
+    auto patch = changes.m_enabled && output.size() == changes.m_size &&
+                 changes.m_offsets.size() == m_table.size() + 1 &&
+                 renderer.layout() == changes.m_layout;
+    if (patch) {
+        for (auto r : changes.m_rows) {
+            if (renderer.rowSize(m_table[r]) + renderer.lineSize() != changes.m_offsets[r + 1] - changes.m_offsets[r]) {
+                patch = false;
+                break;
+            }
+        }
+    }
+
+    std::vector<ByteRange> ranges;
+    if (patch) {
+        std::sort(changes.m_rows.begin(), changes.m_rows.end());
+        ranges.reserve(changes.m_rows.size());
+        for (auto r : changes.m_rows) {
+            const auto offset = changes.m_offsets[r];
+            renderer.writeRow(&output[offset], m_table[r]);
+            ranges.push_back({ offset, renderer.rowSize(m_table[r]) });
+        }
+    } else {
+        output.assign(renderedSize(), '\0');
+        if (!output.empty()) {
+            renderTo(&output[0], output.size());
+            ranges.push_back({ 0, output.size() });
+        }
+
+        changes.m_offsets.resize(m_table.size() + 1);
+        changes.m_offsets[0] = renderer.lineSize();
+        for (RowNumber r = 0; r < m_table.size(); ++r) {
+            changes.m_offsets[r + 1] = changes.m_offsets[r] + renderer.rowSize(m_table[r]) + renderer.lineSize();
+        }
+        changes.m_layout = renderer.layout();
+        changes.m_size = output.size();
+        changes.m_enabled = true;
+    }
+
+    for (auto r : changes.m_rows) {
+        changes.m_flags[r] = false;
+    }
+    changes.m_rows.clear();
+
+    return ranges;
+}
+
+std::ostream &operator<<(std::ostream &os, const Textable &table)
+{
+    if (table.rowCount() == 0) {
+        return os;
+    }
+
+    if (table.m_renderCacheEnabled) {
+        const auto string = table.cachedString(1U);
+        return os.write(string->data(), string->size());
+    }
+
+    const auto renderer = table.makeRenderer();
+    const auto &border = renderer.border();
+
+    // A single buffer for all rows.
+    std::string buffer;
+
+    os.write(border.data(), border.size());
+    for (const auto &row : table.m_table) {
+        const auto size = renderer.rowSize(row);
+        if (size > buffer.size()) {
+            buffer.resize(size);
+        }
+        renderer.writeRow(&buffer[0], row);
+        os.write(buffer.data(), size);
+        os.write(border.data(), border.size());
+    }
+    return os;
 }
@@ -28,11 +28,23 @@
 #include "export.h"
 
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+#include <type_traits>
 #include <vector>
 
+class Renderer;
+
 //! Implements a textual table abstraction.
 /*!
     A text table represents a table-like structure that can be streamed out as
@@ -47,8 +59,9 @@
 
     No special requirements except C++11 compliant compiler.
     In order to properly handle Unicode content all input strings must be UTF-8
-    encoded. The client should set a proper locale too. For example:
-    'std::setlocale(LC_ALL, "en_US.utf8");'.
+    encoded. The column widths are calculated in terminal columns (see the `Unicode`
+    class), so wide CJK characters and combining marks are aligned properly. The
+    calculation doesn't depend on the process locale.
 */
 class TEXTABLE_EXPORT Textable
 {
@@ -64,18 +77,23 @@ public:
     /// Defines the cell data container.
     /*!
         Basically we store the data string itself along with the alignment flag
-        for the given cell.
+        for the given cell. The display width of the data is cached by the table
+        when the cell is stored, so that rendering doesn't need to measure strings.
     */
     struct CellData
     {
         CellData() = default;
-        CellData(const std::string &data, Align align = Align::Center)
+        CellData(std::string data, Align align = Align::Center)
             :
-                m_data(data),
+                m_data(std::move(data)),
                 m_align(align)
         {}
         std::string m_data;
         Align m_align{Align::Center};
+        /// The cached lines of a cell that doesn't fit its column, plus one, or zero.
+        /// Maintained by Textable.
+        uint32_t m_lines = 0;
+        size_t m_width = 0; ///< The display width of the data. Maintained by Textable.
     };
 
     using Row          = std::vector<CellData>;
@@ -83,6 +101,102 @@ public:
     using RowNumber    = Row::size_type;
     using ColumnNumber = Table::size_type;
 
+    /// Defines the formatting of numeric values of a column.
+    /*!
+        Numbers are formatted with the column format when they are stored, so that
+        there is no need to preformat them into strings.
+    */
+    struct ColumnFormat
+    {
+        /// The floating point notation
+        enum class Notation
+        {
+            General,   ///< The shortest of fixed and scientific, as the "%g" printf() format
+            Fixed,     ///< Fixed point, as the "%f" printf() format
+            Scientific ///< Scientific, as the "%e" printf() format
+        };
+
+        Notation m_notation = Notation::General;
+
+        /// The floating point precision. Negative value means the default precision (6).
+        /// Integers are formatted as floating point numbers for the Fixed and Scientific
+        /// notations only.
+        int m_precision = -1;
+
+        /// The thousands separator of the integer part. Zero means no separator.
+        char m_thousandsSeparator = 0;
+
+        /// Whether the numbers of the column are aligned by the decimal point.
+        /*!
+            The block of numbers is aligned within the column according to the cell
+            alignment. Non-numeric cells, e.g. the column title, are aligned as usual.
+        */
+        bool m_decimalAlign = false;
+
+        /// The minimal content width of the column.
+        size_t m_width = 0;
+
+        /// Defines how the cells wider than the maximal column width are shown.
+        enum class Overflow
+        {
+            Truncate, ///< The cell is cut and ends with the ellipsis
+            Wrap      ///< The cell is split into lines at spaces and line breaks, and
+                      ///< within the words that don't fit a line
+        };
+
+        /// The maximal content width of the column. Zero means no limit, and the
+        /// smallest limit is two columns, so that wide characters fit.
+        /*!
+            The lines of the cells that don't fit are found once, when the cell is
+            stored, so rendering such cells costs as much as rendering any other.
+        */
+        size_t m_maxWidth = 0;
+
+        Overflow m_overflow = Overflow::Truncate;
+    };
+
+    /// Defines a part of the table to render, e.g. a page.
+    /*!
+        The ranges are clamped to the table size. The columns keep the widths of the
+        whole table, so that the windows line up with each other and with the full table.
+    */
+    struct Window
+    {
+        RowNumber m_beginRow = 0;                                          ///< The first row
+        RowNumber m_endRow = std::numeric_limits<RowNumber>::max();        ///< The row past the last one
+        ColumnNumber m_beginColumn = 0;                                    ///< The first column
+        ColumnNumber m_endColumn = std::numeric_limits<ColumnNumber>::max(); ///< The column past the last one
+
+        /// The number of the first table rows to repeat at the top of the window.
+        /*!
+            The header rows are not repeated, if the window starts within the header.
+        */
+        RowNumber m_headerRows = 0;
+    };
+
+    class MemoryPool;
+
+    //! Constructs an empty table.
+    Textable() = default;
+
+    //! Constructs an empty table that takes its memory from the given \p pool.
+    /*!
+        The table takes the memory of its rows, cell strings and bookkeeping from the
+        \p pool and gives it back when it is destroyed or cleared. Thus, the tables that
+        are built and discarded one after another, e.g. one per request, reuse the same
+        memory instead of allocating it. The copies of the table use the same pool.
+        The \p pool should outlive the table.
+    */
+    explicit Textable(MemoryPool &pool);
+
+    Textable(const Textable &) = default;
+    Textable(Textable &&) = default;
+    Textable &operator=(const Textable &) = default;
+    Textable &operator=(Textable &&) = default;
+
+    //! Destroys the table, giving its memory back to the memory pool, if any.
+    ~Textable();
+
     //! Sets a value to the cell referred by the given \p row and \p column.
     /*!
         If table doesn't have the referred cell a new row and/or column will be added.
@@ -95,6 +209,21 @@ public:
     template<typename T>
     void setCell(RowNumber row, ColumnNumber column, Align align, T && value);
 
+    //! Sets the text of the given \p size to the cell referred by the given \p row and \p column.
+    /*!
+        The text is borrowed: it is copied into the cell directly, without intermediate
+        strings, so that it needs not to be kept alive after the call.
+    */
+    void setCell(RowNumber row, ColumnNumber column, Align align, const char *data, size_t size);
+
+#if __cplusplus >= 201703L
+    //! Sets the text of the \p value string view to the cell referred by the given \p row and \p column.
+    void setCell(RowNumber row, ColumnNumber column, Align align, std::string_view value)
+    {
+        setCell(row, column, align, value.data(), value.size());
+    }
+#endif
+
     //! Sets a complete row values.
     /*!
         Allows to set up a complete row at once. The \p rowData is a container
@@ -103,11 +232,13 @@ public:
         \param row     The row number
         \param align   The cell texts alignment - common for the whole row.
         \param rowData A container whose elements should be convertible to string.
+                       Strings are not treated as containers of characters.
         \example
             Textable textable;
             textable.setRow(1, Textable::Align::Left, std::vector<std::string>{ "first", "second", "third" });
     */
-    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type>
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
     void setRow(RowNumber row, Align align, T && rowData);
 
     //! Populates a row with values of arbitrary types.
@@ -130,11 +261,13 @@ public:
         \param column     The column number
         \param align      The cell texts alignment - common for the whole column.
         \param columnData A container whose elements should be convertible to string.
+                          Strings are not treated as containers of characters.
         \example
             Textable textable;
             textable.setColumn(3, Textable::Align::Left, std::vector<double>{ 0.0, 1.1, 2.2 });
     */
-    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type>
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
     void setColumn(ColumnNumber column, Align align, T && columnData);
 
     //! Populates a column with values of arbitrary types.
@@ -149,10 +282,82 @@ public:
     template<typename Value, typename... Ts>
     void setColumn(ColumnNumber column, Align align, Value && value, Ts &&... restValues);
 
+    //! Reserves the memory for the given number of \p rows and \p columns.
+    /*!
+        The rows created after this call allocate room for \p columns cells at once,
+        so that filling a table in the row order doesn't reallocate neither the table
+        nor its rows.
+    */
+    void reserve(RowNumber rows, ColumnNumber columns);
+
+    //! Removes all rows of the table, but keeps their memory for reuse.
+    /*!
+        The rows and the cell strings of the removed rows are kept, in the memory pool
+        of the table if it has one, so that populating the table again reuses their
+        memory instead of allocating it. Thus, a single table can serve many short lived
+        tables, e.g. one per request, with almost no allocations. The column formats and
+        the render cache setting are kept too.
+    */
+    void clear();
+
+    //! Appends the \p row after the last row of the table.
+    void appendRow(Row row);
+
+    //! Appends a row of the given values after the last row of the table.
+    /*!
+        For example:
+        \code{.cpp}
+            textable.appendRow(Textable::Align::Left, "one", 2, 3.3);
+        \endcode
+    */
+    template<typename Value, typename... Ts>
+    void appendRow(Align align, Value && value, Ts &&... restValues);
+
+    //! Appends a row per record of the [\p first, \p last) range.
+    /*!
+        Each projection makes a cell value out of a record, one projection per column.
+        For example:
+        \code{.cpp}
+            textable.appendRows(people.begin(), people.end(), Textable::Align::Left,
+                                [](const Person &p) { return p.m_name; },
+                                [](const Person &p) { return p.m_age; });
+        \endcode
+        The table memory is reserved at once for the forward iterator ranges.
+    */
+    template<typename Iterator, typename Projection, typename... Projections>
+    void appendRows(Iterator first, Iterator last, Align align, Projection && projection,
+                    Projections &&... restProjections);
+
+    //! Moves all rows of the \p other table after the last row of this table.
+    /*!
+        The rows are moved, not copied, so that the cell strings are not reallocated.
+        The table shape is merged in O(columns), thus the cost is constant per row.
+        The column formats of this table are kept, the \p other table formats apply
+        only to the columns this table has no format for. The \p other table is left empty.
+    */
+    void splice(Textable &&other);
+
+    //! Sets the format of the numeric values of the given \p column.
+    /*!
+        The numeric format applies to the values that are set after this call.
+        The decimal point alignment and the width hint apply to all cells.
+    */
+    void setColumnFormat(ColumnNumber column, const ColumnFormat &format);
+
+    //! Returns the format of the given \p column, or nullptr if the column has no format.
+    const ColumnFormat *columnFormat(ColumnNumber column) const;
+
     //! Returns the number of rows of the table.
+    /*!
+        The value is maintained incrementally, so the call has constant complexity.
+    */
     RowNumber rowCount() const;
 
     //! Returns the number of columns of the table.
+    /*!
+        The number of columns is the size of the longest row. It is maintained
+        incrementally while the table is being populated, so the call has constant complexity.
+    */
     ColumnNumber columnCount() const;
 
     //! Returns a cell data (string) that corresponds to the given \p row and \p column.
@@ -163,45 +368,585 @@ public:
     std::string cellData(RowNumber row, ColumnNumber column) const;
 
     //! Returns the string representation of the data stored in the table.
+    /*!
+        The string is allocated once with the exact size of the output.
+    */
     std::string toString() const;
 
-    friend std::ostream &operator<<(std::ostream &os, const Textable &table);
+    //! Returns the size in bytes of the string representation of the table.
+    size_t renderedSize() const;
+
+    //! Renders the table into the given character \p buffer.
+    /*!
+        The output is not null-terminated. Nothing is written if the \p capacity of the
+        buffer is less than the rendered size of the table.
+        \param buffer   The output buffer
+        \param capacity The size of the output buffer in bytes
+        \returns Returns the rendered size of the table, i.e. the number of bytes written
+                 if the buffer is large enough, or the required buffer size otherwise.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Returns the string representation of the table rendered by multiple threads.
+    /*!
+        Once the column widths are known every row has a fixed byte size, so the rows
+        are partitioned between the threads and each thread writes its slice directly at
+        its offset in the output. The result is identical to the one of `toString()`.
+        \param threadCount The number of threads to use, zero means the number of
+                           hardware threads. Small tables are rendered by fewer threads.
+    */
+    std::string toString(unsigned threadCount) const;
+
+    /// A range of bytes of the rendered table.
+    struct ByteRange
+    {
+        size_t m_offset; ///< The offset of the first byte
+        size_t m_size;   ///< The number of bytes
+    };
+
+    //! Renders the table into the \p output, rewriting only the rows changed since the last call.
+    /*!
+        The first call renders the whole table and starts tracking the modified rows.
+        The following calls expect the \p output of the previous call: while the column
+        widths and the byte sizes of the modified rows stay the same, only the lines of
+        these rows are rewritten in place. Otherwise the whole table is rendered again.
+        \returns Returns the ranges of the rewritten bytes in the increasing order, one per
+                 modified row line, or a single range of the whole output after the full
+                 rendering. The ranges let terminal front ends redraw the changed lines only.
+    */
+    std::vector<ByteRange> renderChanges(std::string &output);
+
+    //! Enables or disables the cache of the rendered table.
+    /*!
+        When the cache is enabled, `toString()`, `snapshot()` and the output stream
+        operator render the table once and reuse the result until the table changes.
+        The cache is disabled by default.
+    */
+    void setRenderCache(bool enabled);
+
+    //! Returns the generation of the table content.
+    /*!
+        The generation changes whenever the table is modified, so two equal
+        generations mean the same rendered table.
+    */
+    uint64_t generation() const;
+
+    //! Returns a shared read-only string representation of the table.
+    /*!
+        The returned string never changes: the table makes a new one when it is modified.
+        Thus, readers can hold it, even in other threads, while the table is modified.
+        With the render cache enabled, the calls return the same string until the table
+        changes. Concurrent calls are safe as long as the table is not modified at the
+        same time.
+    */
+    std::shared_ptr<const std::string> snapshot() const;
+
+    //! Renders the table into the given character \p buffer by multiple threads.
+    /*!
+        Works as `renderTo(char *, size_t)`, but the rows are rendered in parallel.
+        \param buffer      The output buffer
+        \param capacity    The size of the output buffer in bytes
+        \param threadCount The number of threads to use, zero means the number of
+                           hardware threads.
+        \returns Returns the rendered size of the table.
+    */
+    size_t renderTo(char *buffer, size_t capacity, unsigned threadCount) const;
+
+    //! Returns the size of the rendered \p window of the table in bytes.
+    size_t renderedSize(const Window &window) const;
+
+    //! Renders the \p window of the table into the \p buffer of the given \p capacity.
+    /*!
+        Only the rows of the window are rendered, so the cost doesn't depend on the
+        table size, but on the window size. The exception is the decimal point aligned
+        columns, which are measured over all rows.
+        \returns Returns the rendered size of the window. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity, const Window &window) const;
+
+    //! Returns the string representation of the \p window of the table.
+    std::string toString(const Window &window) const;
+
+    //! Returns the content widths of the columns, excluding the cell padding.
+    std::vector<size_t> columnWidths() const;
+
+    friend TEXTABLE_EXPORT std::ostream &operator<<(std::ostream &os, const Textable &table);
 
 private:
+    friend class TableWriter;
+    friend class ChunkedRenderer;
+    friend class ColumnarTextable;
+    friend class LazyTextable;
+    friend class MappedTextable;
+    friend class Renderer;
+    friend class SparseTextable;
+    friend class TextableView;
+    template<typename...> friend class TypedTextable;
+
+    /// Defines the ways a value is converted to the cell text.
+    enum class Conversion
+    {
+        String,   ///< std::string, moved or copied as is
+        CString,  ///< Null-terminated character strings
+        Bool,     ///< "true" or "false"
+        Char,     ///< A single character
+        Signed,   ///< Signed integers
+        Unsigned, ///< Unsigned integers
+        Floating, ///< Floating point numbers, formatted as the "%g" printf() format
+        Stream    ///< Any other type, written to a stream with operator<<
+    };
+
+    /// Selects the conversion for the given value type.
     template<typename T>
-    std::string toString(T && value) const;
+    struct ConversionOf;
 
-    /// Implements the base case for setRow() variadic function template recursion.
+    template<Conversion C>
+    using ConversionTag = std::integral_constant<Conversion, C>;
+
+    /// Converts the given \p value to the cell text.
     /*!
-        This is a final call of variadic parameter pack.
+        Strings, booleans and numbers are converted without streams and locales,
+        and produce exactly the same text as the `std::ostream` formatted output
+        with the default flags and the classic locale. Other types are written to
+        a stream with their `operator<<`.
     */
-    template <typename T>
-    void setRow(T, Align);
+    template<typename T>
+    static std::string valueToString(T && value);
 
-    /// Implements the base case for setColumn() variadic function template recursion.
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::String>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::CString>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::Bool>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::Char>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::Signed>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::Unsigned>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::Floating>);
+    template<typename T>
+    static std::string valueToString(T && value, ConversionTag<Conversion::Stream>);
+
+    /// Selects the numeric type a value is formatted as with a column format.
+    template<typename T>
+    struct NumberOf;
+
+    /// Moves the \p element of a \p Container, if the container is an rvalue.
+    template<typename Container, typename Element>
+    static typename std::conditional<std::is_lvalue_reference<Container>::value, Element &&,
+                                     typename std::remove_reference<Element>::type &&>::type
+    forwardElement(Element && element);
+
+    /// Converts the given \p value to the text of a cell of the given \p column.
     /*!
-        This is a final call of variadic parameter pack.
+        Numbers are formatted with the column format, if any.
     */
-    template <typename T>
-    void setColumn(T, Align);
+    template<typename T>
+    std::string cellText(T && value, ColumnNumber column);
+
+    template<typename T>
+    std::string cellText(T && value, ColumnNumber column, std::true_type /*isNumber*/);
+
+    template<typename T>
+    std::string cellText(T && value, ColumnNumber column, std::false_type /*isNumber*/);
+
+    /// The copied strings reuse the memory of the cleared cells.
+    std::string cellText(const std::string &value, ColumnNumber column);
+    std::string cellText(std::string &value, ColumnNumber column);
+    std::string cellText(const char *value, ColumnNumber column);
+
+    /// Returns a copy of the given text, reusing the memory of a cleared cell if possible.
+    std::string copyText(const char *data, size_t size);
+
+    /// Returns an empty row, reusing the memory of a cleared row if possible.
+    Row takeRow();
+
+    /// Keeps the memory of the given \p row and of its cell strings for reuse.
+    void recycleRow(Row &&row);
+
+    /// Returns the kept rows and cell strings, the ones of the memory pool if the table has one.
+    std::vector<Row> &spareRows();
+    std::vector<std::string> &spareStrings();
+
+    static std::string formatNumber(long long value, const ColumnFormat &format);
+    static std::string formatNumber(unsigned long long value, const ColumnFormat &format);
+    static std::string formatNumber(long double value, const ColumnFormat &format);
+
+    /// Creates a renderer for the current column widths and formats.
+    Renderer makeRenderer() const;
+
+    /// Creates a renderer for the column widths and formats of the given \p rows only.
+    Renderer makeRenderer(const std::vector<RowNumber> &rows) const;
+
+    /// Creates a renderer for the given content \p widths, applying the column formats.
+    /*!
+        The decimal point alignment is measured over the given \p rows, or over all rows
+        if \p rows is nullptr.
+    */
+    Renderer makeRenderer(std::vector<size_t> widths, const std::vector<RowNumber> *rows) const;
+
+    /// Remembers that the given \p row has been modified, if the changes are tracked.
+    void markChanged(RowNumber row);
+
+    /// Tracks the modified rows for `renderChanges()`.
+    struct Changes
+    {
+        bool m_enabled = false;
+
+        /// The modified rows flags and the list of modified rows.
+        std::vector<bool> m_flags;
+        std::vector<RowNumber> m_rows;
+
+        /// The offsets of the row lines and the columns layout of the last rendering.
+        std::vector<size_t> m_offsets;
+        std::vector<size_t> m_layout;
+        size_t m_size = 0;
+    };
+
+    /// Returns the cached rendering of the table, rendering it if the table has changed.
+    std::shared_ptr<const std::string> cachedString(unsigned threadCount) const;
+
+    /// Keeps the last rendering of the table.
+    /*!
+        The cache is not copied along with the table.
+    */
+    struct RenderCache
+    {
+        RenderCache() = default;
+        RenderCache(const RenderCache &) {}
+        RenderCache &operator=(const RenderCache &)
+        {
+            m_string.reset();
+            return *this;
+        }
+
+        std::mutex m_mutex;
+        uint64_t m_generation = 0;
+        std::shared_ptr<const std::string> m_string;
+    };
+
+    /// The rows and the columns of a window, clamped to the table size.
+    struct WindowRange
+    {
+        RowNumber m_headerEnd;
+        RowNumber m_beginRow;
+        RowNumber m_endRow;
+        ColumnNumber m_beginColumn;
+        ColumnNumber m_endColumn;
+    };
+
+    WindowRange windowRange(const Window &window) const;
+
+    /// Returns the size of the rendered window \p range for the given \p renderer.
+    size_t renderedSize(const WindowRange &range, const Renderer &renderer) const;
+
+    static std::string signedToString(long long value);
+    static std::string unsignedToString(unsigned long long value);
+    static std::string floatingToString(double value);
+    static std::string floatingToString(long double value);
+
+    /// Sets the values to the cells of the \p row starting from the given \p column.
+    /*!
+        The position is passed along the recursion instead of being kept in the table,
+        so that the calls don't share any state.
+    */
+    template<typename Value, typename... Ts>
+    void setRowFrom(RowNumber row, ColumnNumber column, Align align, Value && value, Ts &&... restValues);
+
+    /// Sets the container values to the cells of the \p row starting from the given \p column.
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setRowFrom(RowNumber row, ColumnNumber column, Align align, T && rowData);
+
+    /// Implements the base case for setRowFrom() variadic function template recursion.
+    void setRowFrom(RowNumber, ColumnNumber, Align) {}
 
-    /// Returns the real number of string characters.
+    /// Sets the values to the cells of the \p column starting from the given \p row.
+    template<typename Value, typename... Ts>
+    void setColumnFrom(ColumnNumber column, RowNumber row, Align align, Value && value, Ts &&... restValues);
+
+    /// Sets the container values to the cells of the \p column starting from the given \p row.
+    template<typename T, typename U = typename std::decay<decltype(*begin(std::declval<T>()))>::type,
+             typename = typename std::enable_if<!std::is_convertible<T, std::string>::value>::type>
+    void setColumnFrom(ColumnNumber column, RowNumber row, Align align, T && columnData);
+
+    /// Implements the base case for setColumnFrom() variadic function template recursion.
+    void setColumnFrom(ColumnNumber, RowNumber, Align) {}
+
+    /// Returns the display width of the string.
     /*!
         In cases when string stores multi byte characters, std::string::size() function
-        will return the number of *bytes*, not characters.
+        will return the number of *bytes*, not the number of occupied columns.
     */
     static size_t stringSize(const std::string &string);
 
+    /// Reserves the table rows for the [\p first, \p last) range of forward iterators.
+    template<typename Iterator>
+    void reserveRows(Iterator first, Iterator last, std::forward_iterator_tag);
+
+    /// Can't know the size of the input iterators range up front.
+    template<typename Iterator>
+    void reserveRows(Iterator, Iterator, std::input_iterator_tag) {}
+
+    /// Makes sure that the table has at least \p count rows.
+    void ensureRowCount(RowNumber count);
+
+    /// Makes sure that the given \p row has at least \p count cells and returns the row.
+    Row &ensureCellCount(RowNumber row, ColumnNumber count);
+
+    /// Replaces the given \p row with the \p newRow and updates the table shape.
+    void replaceRow(RowNumber row, Row &&newRow);
+
+    /// Updates the row sizes histogram and the column count after a row resize.
+    void updateRowSize(ColumnNumber oldSize, ColumnNumber newSize);
+
+    /// Stores the \p cell at the given position, caches its width and updates the column width.
+    /*!
+        The cell should exist already.
+    */
+    void storeCell(RowNumber row, ColumnNumber column, CellData &&cell);
+
+    /// Updates the \p column width after a cell of the column changed its width.
+    /*!
+        Should be called after the cell is already stored in the table.
+    */
+    void updateColumnWidth(ColumnNumber column, size_t oldWidth, size_t newWidth);
+
+    /// A line of a cell that doesn't fit its column.
+    struct CellLine
+    {
+        size_t m_offset; ///< The offset of the line in the cell text
+        size_t m_size;
+        size_t m_width;
+    };
+
+    /// The lines of a cell that doesn't fit its column, see `CellData::m_lines`.
+    struct CellLines
+    {
+        std::vector<CellLine> m_lines;
+        bool m_ellipsis = false; ///< Whether the only line is followed by the ellipsis
+    };
+
+    /// Breaks the \p cell into the \p lines according to the \p format.
+    /*!
+        \returns Returns false if the cell fits the column as is.
+    */
+    static bool breakCell(const CellData &cell, const ColumnFormat &format, CellLines &lines);
+
+    /// Caches the lines of the \p cell, if it doesn't fit the given \p column.
+    void updateCellLines(CellData &cell, ColumnNumber column);
+
+    /// Releases the cached lines of the \p cell.
+    void releaseCellLines(CellData &cell);
+
+    /// Holds the width of a column.
+    struct ColumnWidth
+    {
+        size_t m_width = 0;     ///< The widest cell width.
+        RowNumber m_count = 0;  ///< The number of cells that have the widest width.
+    };
+
+    Table m_table;
+
+    /// The size of the longest row, i.e. the number of columns.
+    ColumnNumber m_columnCount = {};
+
+    /// The number of rows per row size (the index). Empty rows are not counted.
+    std::vector<RowNumber> m_rowSizes;
+
+    /// The width of each column. Can be longer than the number of columns.
+    std::vector<ColumnWidth> m_columnWidths;
+
+    /// The number of cells to reserve in new rows.
+    ColumnNumber m_reservedColumns = {};
+
+    /// The formats of the formatted columns.
+    std::map<ColumnNumber, ColumnFormat> m_formats;
+
+    /// Whether some of the formats limit the column width.
+    bool m_hasMaxWidths = false;
+
+    /// The lines of the cells that don't fit their columns, and the free elements.
+    std::vector<CellLines> m_cellLines;
+    std::vector<uint32_t> m_freeCellLines;
+
+    /// Changes with every modification of the table.
+    uint64_t m_generation = 0;
+
+    Changes m_changes;
+
+    /// The memory of the cleared rows and cell strings, kept for reuse.
+    std::vector<Row> m_spareRows;
+    std::vector<std::string> m_spareStrings;
+
+    /// The pool the table takes its memory from, if any.
+    MemoryPool *m_pool = nullptr;
+
+    bool m_renderCacheEnabled = false;
+    mutable RenderCache m_renderCache;
+};
+
+//! Keeps the memory of the destroyed and cleared tables for the next tables.
+/*!
+    The tables constructed with a pool share the memory of their rows, cell strings and
+    bookkeeping through it. The pool keeps the memory of the last given table only, so
+    that it doesn't grow with the rows and strings moved into the tables.
+
+    The pool is not thread-safe: the tables of a pool should be modified and destroyed
+    by one thread at a time, e.g. use a pool per thread.
+    \code{.cpp}
+        thread_local Textable::MemoryPool pool;
+        Textable textable(pool);
+    \endcode
+*/
+class Textable::MemoryPool
+{
+public:
+    MemoryPool() = default;
+    MemoryPool(const MemoryPool &) = delete;
+    MemoryPool &operator=(const MemoryPool &) = delete;
+
+private:
+    friend class Textable;
+
+    std::vector<Row> m_rows;
+    std::vector<std::string> m_strings;
     Table m_table;
-    Textable::ColumnNumber m_currentColumn = {};
-    Textable::RowNumber m_currentRow = {};
+    std::vector<RowNumber> m_rowSizes;
+    std::vector<ColumnWidth> m_columnWidths;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // Definition of the function templates
 
 template<typename T>
-std::string Textable::toString(T && value) const
+struct Textable::ConversionOf
+{
+    using Type = typename std::decay<T>::type;
+
+    static const bool isChar = std::is_same<Type, char>::value ||
+                               std::is_same<Type, signed char>::value ||
+                               std::is_same<Type, unsigned char>::value;
+
+    static const bool isBool = std::is_same<Type, bool>::value ||
+                               std::is_same<Type, std::vector<bool>::reference>::value ||
+                               std::is_same<Type, std::vector<bool>::const_reference>::value;
+
+    static const Conversion value =
+        std::is_same<Type, std::string>::value ? Conversion::String :
+        std::is_same<Type, char *>::value || std::is_same<Type, const char *>::value ? Conversion::CString :
+        isBool ? Conversion::Bool :
+        isChar ? Conversion::Char :
+        std::is_integral<Type>::value && std::is_signed<Type>::value ? Conversion::Signed :
+        std::is_integral<Type>::value ? Conversion::Unsigned :
+        std::is_floating_point<Type>::value ? Conversion::Floating :
+        Conversion::Stream;
+};
+
+template<typename T>
+std::string Textable::valueToString(T && value)
+{
+    return valueToString(std::forward<T>(value), ConversionTag<ConversionOf<T>::value>{});
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::String>)
+{
+    // Moves rvalue strings.
+    return std::forward<T>(value);
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::CString>)
+{
+    // Character arrays decay to pointers here.
+    const char *string = value;
+    return string ? std::string(string) : std::string{};
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::Bool>)
+{
+    return static_cast<bool>(value) ? "true" : "false";
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::Char>)
+{
+    return std::string(1, static_cast<char>(value));
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::Signed>)
+{
+    return signedToString(static_cast<long long>(value));
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::Unsigned>)
+{
+    return unsignedToString(static_cast<unsigned long long>(value));
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::Floating>)
+{
+    using Type = typename std::conditional<std::is_same<typename std::decay<T>::type, long double>::value,
+                                           long double, double>::type;
+    return floatingToString(static_cast<Type>(value));
+}
+
+template<typename T>
+struct Textable::NumberOf
+{
+    static const Conversion conversion = ConversionOf<T>::value;
+
+    using Type = typename std::conditional<conversion == Conversion::Floating, long double,
+                 typename std::conditional<conversion == Conversion::Signed, long long,
+                                           unsigned long long>::type>::type;
+
+    using IsNumber = std::integral_constant<bool, conversion == Conversion::Signed ||
+                                                  conversion == Conversion::Unsigned ||
+                                                  conversion == Conversion::Floating>;
+};
+
+template<typename Container, typename Element>
+typename std::conditional<std::is_lvalue_reference<Container>::value, Element &&,
+                          typename std::remove_reference<Element>::type &&>::type
+Textable::forwardElement(Element && element)
+{
+    using Result = typename std::conditional<std::is_lvalue_reference<Container>::value, Element &&,
+                                             typename std::remove_reference<Element>::type &&>::type;
+    return static_cast<Result>(element);
+}
+
+template<typename T>
+std::string Textable::cellText(T && value, ColumnNumber column)
+{
+    return cellText(std::forward<T>(value), column, typename NumberOf<T>::IsNumber{});
+}
+
+template<typename T>
+std::string Textable::cellText(T && value, ColumnNumber column, std::true_type)
+{
+    if (const auto format = columnFormat(column)) {
+        return formatNumber(static_cast<typename NumberOf<T>::Type>(value), *format);
+    }
+    return valueToString(std::forward<T>(value));
+}
+
+template<typename T>
+std::string Textable::cellText(T && value, ColumnNumber, std::false_type)
+{
+    return valueToString(std::forward<T>(value));
+}
+
+template<typename T>
+std::string Textable::valueToString(T && value, ConversionTag<Conversion::Stream>)
 {
     std::ostringstream stream;
     stream << std::boolalpha << std::forward<T>(value);
@@ -211,164 +956,116 @@ std::string Textable::toString(T && value) const
 template<typename T>
 void Textable::setCell(RowNumber row, ColumnNumber column, Align align, T && value)
 {
-    if (row + 1 > rowCount()) {
-        m_table.resize(row + 1);
-    }
-    auto &rowObj = m_table.at(row);
-
-    if (column + 1 > rowObj.size()) {
-        rowObj.resize(column + 1);
-    }
-
-    rowObj.at(column) = {toString(std::forward<T>(value)), align};
+    ensureCellCount(row, column + 1);
+    storeCell(row, column, {cellText(std::forward<T>(value), column), align});
 }
 
 // The specialization for Textable::Row data. We don't need to perform values conversion.
 template<>
 inline void Textable::setRow(RowNumber row, Align /*align*/, Textable::Row && rowData)
 {
-    if (row + 1 > rowCount()) {
-        m_table.resize(row + 1);
-    }
-    m_table.at(row) = rowData;
+    ensureRowCount(row + 1);
+    replaceRow(row, std::move(rowData));
 }
 
-template<typename T, typename U>
+template<typename T, typename U, typename>
 void Textable::setRow(RowNumber row, Align align, T && rowData)
 {
-    if (row + 1 > rowCount()) {
-        m_table.resize(row + 1);
-    }
+    ensureRowCount(row + 1);
 
-    Textable::Row newRow;
+    auto newRow = takeRow();
     newRow.reserve(rowData.size());
 
-    for (const auto &value : rowData) {
-        newRow.emplace_back(toString(value), align);
+    for (auto &&value : rowData) {
+        newRow.emplace_back(cellText(forwardElement<T>(value), newRow.size()), align);
     }
 
-    if (m_currentColumn == 0) {
-        m_table.at(row) = newRow;
-    } else {
-        auto &currentRow = m_table.at(row);
-        currentRow.reserve(currentRow.size() + newRow.size());
-        currentRow.insert(currentRow.end(), newRow.begin(), newRow.end());
-    }
+    replaceRow(row, std::move(newRow));
 }
 
-template <typename T>
-void Textable::setRow(T, Align)
+template<typename T, typename U, typename>
+void Textable::setRowFrom(RowNumber row, ColumnNumber column, Align align, T && rowData)
 {
-    // Do nothing.
+    for (auto &&value : rowData) {
+        setCell(row, column++, align, forwardElement<T>(value));
+    }
 }
 
 template<typename Value, typename... Ts>
 void Textable::setRow(RowNumber row, Align align, Value && value, Ts &&... restValues)
 {
-    setCell(row, m_currentColumn++, align, std::forward<Value>(value));
-    // The recursive call.
-    setRow(row, align, std::forward<Ts>(restValues)...);
-
-    // Reset the counter.
-    m_currentColumn = {};
+    setRowFrom(row, 0, align, std::forward<Value>(value), std::forward<Ts>(restValues)...);
 }
 
 template<typename Value, typename... Ts>
-void Textable::setColumn(ColumnNumber column, Align align, Value && value, Ts &&... restValues)
+void Textable::setRowFrom(RowNumber row, ColumnNumber column, Align align, Value && value, Ts &&... restValues)
 {
-    setCell(m_currentRow++, column, align, std::forward<Value>(value));
+    setCell(row, column, align, std::forward<Value>(value));
     // The recursive call.
-    setColumn(column, align, std::forward<Ts>(restValues)...);
+    setRowFrom(row, column + 1, align, std::forward<Ts>(restValues)...);
+}
 
-    // Reset the counter.
-    m_currentRow = {};
+template<typename Value, typename... Ts>
+void Textable::setColumn(ColumnNumber column, Align align, Value && value, Ts &&... restValues)
+{
+    setColumnFrom(column, 0, align, std::forward<Value>(value), std::forward<Ts>(restValues)...);
 }
 
-template <typename T>
-void Textable::setColumn(T, Align)
+template<typename Value, typename... Ts>
+void Textable::setColumnFrom(ColumnNumber column, RowNumber row, Align align, Value && value, Ts &&... restValues)
 {
-    // Do nothing.
+    setCell(row, column, align, std::forward<Value>(value));
+    // The recursive call.
+    setColumnFrom(column, row + 1, align, std::forward<Ts>(restValues)...);
 }
 
-template<typename T, typename U>
-void Textable::setColumn(ColumnNumber column, Align align, T && columnData)
+template<typename Value, typename... Ts>
+void Textable::appendRow(Align align, Value && value, Ts &&... restValues)
 {
-    if (columnData.size() > rowCount()) {
-        m_table.resize(columnData.size() + m_currentRow);
-    }
+    auto newRow = takeRow();
+    newRow.reserve(1 + sizeof...(Ts));
+    newRow.emplace_back(cellText(std::forward<Value>(value), 0), align);
+    const int expand[] = { 0, (newRow.emplace_back(cellText(std::forward<Ts>(restValues), newRow.size()), align), 0)... };
+    (void)expand;
 
-    for (decltype(columnData.size()) r = 0; r < columnData.size(); ++r) {
-        const auto insertionRow = m_currentRow + r;
-        auto &row = m_table.at(insertionRow);
-        if (column + 1 > row.size()) {
-            row.resize(column + 1);
-        }
+    appendRow(std::move(newRow));
+}
 
-        row.at(column) = {toString(columnData.at(r)), align};
-    }
+template<typename Iterator>
+void Textable::reserveRows(Iterator first, Iterator last, std::forward_iterator_tag)
+{
+    m_table.reserve(m_table.size() + static_cast<RowNumber>(std::distance(first, last)));
 }
 
-std::ostream &operator<<(std::ostream &os, const Textable &table)
+template<typename Iterator, typename Projection, typename... Projections>
+void Textable::appendRows(Iterator first, Iterator last, Align align, Projection && projection,
+                          Projections &&... restProjections)
 {
-    if (table.rowCount() == 0) {
-        return os;
-    }
+    reserveRows(first, last, typename std::iterator_traits<Iterator>::iterator_category{});
 
-    std::vector<Textable::ColumnNumber> columnWidths(table.columnCount(), 0);
-
-    // Find max. width for each column.
-    for (const auto &row : table.m_table) {
-        for (auto c = 0U; c < row.size(); ++c) {
-            assert(c < columnWidths.size());
-            static const auto offset = Textable::ColumnNumber(2);
-            const auto valueSize = Textable::stringSize(row.at(c).m_data) + offset;
-            if (valueSize > columnWidths.at(c)) {
-                columnWidths.at(c) = valueSize;
-            }
-        }
+    for (; first != last; ++first) {
+        const auto &record = *first;
+        appendRow(align, projection(record), restProjections(record)...);
     }
+}
 
-    auto drawLine = [&]() {
-        os << '+';
-        for (auto c = 0U; c < table.columnCount(); ++c) {
-            os << std::string(columnWidths.at(c), '-') << '+';
-        }
-        os << '\n';
-    };
+template<typename T, typename U, typename>
+void Textable::setColumn(ColumnNumber column, Align align, T && columnData)
+{
+    setColumnFrom(column, 0, align, std::forward<T>(columnData));
+}
 
-    drawLine();
-
-    for (const auto &row : table.m_table) {
-        os << '|';
-        for (auto c = 0U; c < table.columnCount(); ++c) {
-            auto spaceCount = columnWidths.at(c);
-
-            if (c < row.size()) {
-                const auto &cellValue = row.at(c);
-                const auto &data = cellValue.m_data;
-                spaceCount -= Textable::stringSize(data);
-
-                if (cellValue.m_align == Textable::Align::Left) {
-                    os << data << std::string(spaceCount, ' ');
-                } else if (cellValue.m_align == Textable::Align::Right) {
-                    os << std::string(spaceCount, ' ') << data;
-                } else if (cellValue.m_align == Textable::Align::Center) {
-                    const auto leftSpace = spaceCount / 2;
-                    const auto rightSpace = spaceCount - leftSpace;
-                    os << std::string(leftSpace, ' ') << data << std::string(rightSpace, ' ');
-                }
-            } else {
-                os << std::string(spaceCount, ' ');
-            }
-            os << '|';
-        }
-        os << '\n';
+template<typename T, typename U, typename>
+void Textable::setColumnFrom(ColumnNumber column, RowNumber row, Align align, T && columnData)
+{
+    ensureRowCount(row + columnData.size());
 
-        drawLine();
+    for (decltype(columnData.size()) r = 0; r < columnData.size(); ++r) {
+        const auto insertionRow = row + r;
+        ensureCellCount(insertionRow, column + 1);
+        storeCell(insertionRow, column, {cellText(forwardElement<T>(columnData.at(r)), column), align});
     }
-    return os;
 }
 
-
 #endif // !__TEXTABLE_H__
 
@@ -0,0 +1,111 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "textablebuilder.h"
+
+#include <atomic>
+
+namespace
+{
+
+/// The last shard of the thread, cached per thread to find it without locking.
+struct ShardCache
+{
+    uint64_t m_builder = 0;
+    Textable *m_table = nullptr;
+};
+
+thread_local ShardCache shardCache;
+
+} // namespace
+
+uint64_t TextableBuilder::nextId()
+{
+    // Zero is never used, so that the empty cache never matches a builder.
+    static std::atomic<uint64_t> lastId(0);
+    return ++lastId;
+}
+
+TextableBuilder::TextableBuilder()
+    :
+        m_id(nextId())
+{}
+
+Textable &TextableBuilder::shard()
+{
+    if (shardCache.m_builder == m_id) {
+        return *shardCache.m_table;
+    }
+
+    const auto thread = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Textable *table = nullptr;
+    for (const auto &shard : m_shards) {
+        if (shard->m_thread == thread) {
+            table = &shard->m_table;
+            break;
+        }
+    }
+    if (!table) {
+        m_shards.emplace_back(new Shard{thread, Textable()});
+        table = &m_shards.back()->m_table;
+    }
+
+    shardCache.m_builder = m_id;
+    shardCache.m_table = table;
+    return *table;
+}
+
+void TextableBuilder::appendRow(Textable::Row row)
+{
+    shard().appendRow(std::move(row));
+}
+
+size_t TextableBuilder::shardCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_shards.size();
+}
+
+Textable TextableBuilder::build()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Textable result;
+    Textable::RowNumber rowCount = 0;
+    for (const auto &shard : m_shards) {
+        rowCount += shard->m_table.rowCount();
+    }
+    result.reserve(rowCount, 0);
+
+    for (const auto &shard : m_shards) {
+        result.splice(std::move(shard->m_table));
+    }
+    m_shards.clear();
+
+    // Invalidate the thread caches that point to the destroyed shards.
+    m_id = nextId();
+    return result;
+}
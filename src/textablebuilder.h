@@ -0,0 +1,121 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __TEXTABLEBUILDER_H__
+#define __TEXTABLEBUILDER_H__
+
+#include "textable.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Implements a builder of a table that is populated by multiple threads.
+/*!
+    A `Textable` can't be modified by multiple threads at once, even if they write to
+    different rows, as all rows share the table shape. The builder gives each producer
+    thread its own shard - a partial table - so that the threads append rows without
+    locking. The shards are spliced into one table at the end, which moves the rows
+    without copying the cell strings.
+
+    The rows of the built table are grouped by shard in the order the shards were created,
+    i.e. in the order the threads appended their first rows. The rows of a thread keep
+    their order.
+
+    \example
+        TextableBuilder builder;
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&builder, t]() {
+                for (int i = 0; i < 1000; ++i) {
+                    builder.appendRow(Textable::Align::Left, t, i, "value");
+                }
+            });
+        }
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        Textable textable = builder.build();
+*/
+class TEXTABLE_EXPORT TextableBuilder
+{
+public:
+    TextableBuilder();
+
+    TextableBuilder(const TextableBuilder &) = delete;
+    TextableBuilder &operator=(const TextableBuilder &) = delete;
+
+    //! Returns the shard of the calling thread.
+    /*!
+        The shard is created on the first call of the thread. The following calls
+        return it without locking. The shard should only be used by the calling thread.
+    */
+    Textable &shard();
+
+    //! Appends the \p row to the shard of the calling thread.
+    void appendRow(Textable::Row row);
+
+    //! Appends a row of the given values to the shard of the calling thread.
+    template<typename Value, typename... Ts>
+    void appendRow(Textable::Align align, Value && value, Ts &&... restValues);
+
+    //! Returns the number of the shards created so far.
+    size_t shardCount() const;
+
+    //! Splices all shards into a single table and resets the builder.
+    /*!
+        Should be called after the producer threads have finished. The builder can be
+        populated again afterwards.
+    */
+    Textable build();
+
+private:
+    /// A shard of the table and its owner thread.
+    struct Shard
+    {
+        std::thread::id m_thread;
+        Textable m_table;
+    };
+
+    /// Identifies the builder and its shards generation in the thread caches.
+    static uint64_t nextId();
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    uint64_t m_id;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Definition of the function templates
+
+template<typename Value, typename... Ts>
+void TextableBuilder::appendRow(Textable::Align align, Value && value, Ts &&... restValues)
+{
+    shard().appendRow(align, std::forward<Value>(value), std::forward<Ts>(restValues)...);
+}
+
+#endif // !__TEXTABLEBUILDER_H__
@@ -0,0 +1,275 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "textableview.h"
+#include "parallel.h"
+#include "renderer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <clocale>
+#include <cstdlib>
+
+namespace
+{
+
+/// The sort key of a cell.
+struct Key
+{
+    bool m_isNumber;
+    double m_number;
+    const std::string *m_text;
+};
+
+/// Parses the number of the given \p text.
+/*!
+    The numbers are recognized as the decimal alignment does, with the digit group
+    separators. The parsing doesn't depend on the process locale.
+*/
+bool parseNumber(const std::string &text, double &number)
+{
+    size_t integerWidth = 0;
+    size_t fractionWidth = 0;
+    if (!Renderer::numberParts(text.data(), text.size(), integerWidth, fractionWidth)) {
+        return false;
+    }
+
+    const auto decimalPoint = std::localeconv()->decimal_point[0];
+
+    char buffer[64];
+    std::string large;
+    auto out = buffer;
+    if (text.size() >= sizeof(buffer)) {
+        large.resize(text.size() + 1);
+        out = &large[0];
+    }
+    const auto begin = out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const auto c = text[i];
+        if (i < integerWidth && (c == ',' || c == '\'' || c == ' ')) {
+            continue;
+        }
+        *out++ = c == '.' ? decimalPoint : c;
+    }
+    *out = '\0';
+
+    number = std::strtod(begin, nullptr);
+    return true;
+}
+
+/// Compares the keys in the ascending order.
+bool lessKey(const Key &left, const Key &right)
+{
+    if (left.m_isNumber != right.m_isNumber) {
+        return left.m_isNumber;
+    }
+    if (left.m_isNumber) {
+        return left.m_number < right.m_number;
+    }
+    return *left.m_text < *right.m_text;
+}
+
+const std::string emptyText;
+
+} // namespace
+
+TextableView::TextableView(const Textable &table, RowNumber headerRows)
+    :
+        m_table(&table),
+        m_headerRows(std::min(headerRows, table.rowCount()))
+{
+    reset();
+}
+
+TextableView &TextableView::reset()
+{
+    m_rows.resize(m_table->rowCount() - m_headerRows);
+    for (RowNumber r = 0; r < m_rows.size(); ++r) {
+        m_rows[r] = m_headerRows + r;
+    }
+    return *this;
+}
+
+TextableView &TextableView::sort(ColumnNumber column, Order order, unsigned threadCount)
+{
+    // Parse the keys once, rather than on every comparison. The keys refer to the cell texts.
+    std::vector<Key> keys(m_rows.size());
+    for (size_t i = 0; i < m_rows.size(); ++i) {
+        const auto &row = m_table->m_table[m_rows[i]];
+        auto &key = keys[i];
+        key.m_text = column < row.size() ? &row[column].m_data : &emptyText;
+        key.m_isNumber = parseNumber(*key.m_text, key.m_number);
+    }
+
+    // Sort the positions of the keys.
+    std::vector<size_t> positions(m_rows.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i] = i;
+    }
+    const auto descending = order == Order::Descending;
+    auto less = [&keys, descending](size_t left, size_t right) {
+        return descending ? lessKey(keys[right], keys[left]) : lessKey(keys[left], keys[right]);
+    };
+
+    // Not worth a thread below this number of rows.
+    static const size_t minRowsPerThread = 16384;
+
+    const auto slices = parallel::sliceCount(positions.size(), parallel::threadCount(threadCount),
+                                             minRowsPerThread);
+    std::vector<size_t> bounds(slices + 1);
+    parallel::forEachSlice(positions.size(), slices, [&](unsigned slice, size_t begin, size_t end) {
+        std::stable_sort(positions.begin() + begin, positions.begin() + end, less);
+        bounds[slice] = begin;
+        bounds[slice + 1] = end;
+    });
+
+    // Merge the sorted slices pairwise, the pairs of each level in parallel.
+    for (unsigned width = 1; width < slices; width *= 2) {
+        const auto pairs = (slices + 2 * width - 1) / (2 * width);
+        parallel::forEachSlice(pairs, pairs, [&](unsigned, size_t pair, size_t) {
+            const auto first = pair * 2 * width;
+            const auto middle = std::min<size_t>(first + width, slices);
+            const auto last = std::min<size_t>(first + 2 * width, slices);
+            if (middle < last) {
+                std::inplace_merge(positions.begin() + bounds[first], positions.begin() + bounds[middle],
+                                   positions.begin() + bounds[last], less);
+            }
+        });
+    }
+
+    std::vector<RowNumber> rows(m_rows.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        rows[i] = m_rows[positions[i]];
+    }
+    m_rows.swap(rows);
+    return *this;
+}
+
+TextableView::RowNumber TextableView::rowCount() const
+{
+    return m_headerRows + m_rows.size();
+}
+
+TextableView::RowNumber TextableView::tableRow(RowNumber row) const
+{
+    assert(row < rowCount());
+    return row < m_headerRows ? row : m_rows[row - m_headerRows];
+}
+
+std::vector<TextableView::RowNumber> TextableView::visibleRows() const
+{
+    std::vector<RowNumber> rows;
+    rows.reserve(rowCount());
+    for (RowNumber r = 0; r < m_headerRows; ++r) {
+        rows.push_back(r);
+    }
+    rows.insert(rows.end(), m_rows.begin(), m_rows.end());
+    return rows;
+}
+
+std::vector<size_t> TextableView::columnWidths() const
+{
+    return m_table->makeRenderer(visibleRows()).columnWidths();
+}
+
+size_t TextableView::renderedSize() const
+{
+    if (rowCount() == 0) {
+        return 0;
+    }
+
+    const auto rows = visibleRows();
+    const auto renderer = m_table->makeRenderer(rows);
+    auto size = renderer.lineSize();
+    for (auto r : rows) {
+        size += renderer.rowSize(m_table->m_table[r]) + renderer.lineSize();
+    }
+    return size;
+}
+
+size_t TextableView::renderTo(char *buffer, size_t capacity) const
+{
+    if (rowCount() == 0) {
+        return 0;
+    }
+
+    const auto rows = visibleRows();
+    const auto renderer = m_table->makeRenderer(rows);
+    auto size = renderer.lineSize();
+    for (auto r : rows) {
+        size += renderer.rowSize(m_table->m_table[r]) + renderer.lineSize();
+    }
+    if (size > capacity) {
+        return size;
+    }
+
+    auto out = renderer.writeBorder(buffer);
+    for (auto r : rows) {
+        out = renderer.writeRow(out, m_table->m_table[r]);
+        out = renderer.writeBorder(out);
+    }
+    assert(out == buffer + size);
+    return size;
+}
+
+std::string TextableView::toString() const
+{
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size());
+    }
+    return result;
+}
+
+void TextableView::write(std::ostream &os) const
+{
+    if (rowCount() == 0) {
+        return;
+    }
+
+    const auto rows = visibleRows();
+    const auto renderer = m_table->makeRenderer(rows);
+    const auto &border = renderer.border();
+
+    // A single buffer for all rows.
+    std::string buffer;
+
+    os.write(border.data(), border.size());
+    for (auto r : rows) {
+        const auto &row = m_table->m_table[r];
+        const auto size = renderer.rowSize(row);
+        if (size > buffer.size()) {
+            buffer.resize(size);
+        }
+        renderer.writeRow(&buffer[0], row);
+        os.write(buffer.data(), size);
+        os.write(border.data(), border.size());
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, const TextableView &view)
+{
+    view.write(os);
+    return os;
+}
@@ -0,0 +1,146 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __TEXTABLEVIEW_H__
+#define __TEXTABLEVIEW_H__
+
+#include "textable.h"
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Implements a sorted and/or filtered view of a table.
+/*!
+    The view holds the indexes of the visible table rows in their display order, and
+    refers to the cells of the table. Neither creating, sorting, filtering nor rendering
+    a view copies the cells. The column widths are calculated over the visible rows
+    only, while the number of columns is the one of the table.
+
+    The view refers to the table, so the table should outlive the view, and should not
+    be modified while the view is used.
+
+    \example
+        TextableView view(textable, 1); // Keep the first row on top
+        view.filter([](const Textable::Row &row) { return row.size() > 2 && row[2].m_data != "0"; })
+            .sort(1, TextableView::Order::Descending);
+        std::cout << view;
+*/
+class TEXTABLE_EXPORT TextableView
+{
+public:
+    using RowNumber    = Textable::RowNumber;
+    using ColumnNumber = Textable::ColumnNumber;
+
+    /// Defines the sort order.
+    enum class Order
+    {
+        Ascending,
+        Descending
+    };
+
+    //! Constructs a view of all rows of the \p table.
+    /*!
+        \param table      The viewed table
+        \param headerRows The number of the first table rows that stay on top of the view,
+                          and are neither sorted nor filtered.
+    */
+    explicit TextableView(const Textable &table, RowNumber headerRows = 0);
+
+    //! Keeps the visible rows, for which the \p predicate returns true.
+    /*!
+        The predicate is called with a `const Textable::Row &` argument.
+    */
+    template<typename Predicate>
+    TextableView &filter(Predicate && predicate);
+
+    //! Sorts the visible rows by the values of the given \p column.
+    /*!
+        Numbers are compared by their values and precede other texts, which are compared
+        byte by byte. Missing cells compare as empty texts. The sort is stable, so that
+        sorting by several columns one after another gives the order of the last column,
+        then of the previous ones.
+        \param column      The column to sort by
+        \param order       The sort order
+        \param threadCount The number of threads to use, zero means the number of
+                           hardware threads. Small views are sorted by a single thread.
+    */
+    TextableView &sort(ColumnNumber column, Order order = Order::Ascending, unsigned threadCount = 1);
+
+    //! Shows all rows of the table in their original order again.
+    TextableView &reset();
+
+    //! Returns the number of the visible rows, including the header rows.
+    RowNumber rowCount() const;
+
+    //! Returns the table row number of the given visible \p row.
+    RowNumber tableRow(RowNumber row) const;
+
+    //! Returns the content widths of the columns over the visible rows.
+    std::vector<size_t> columnWidths() const;
+
+    //! Returns the size of the rendered view in bytes.
+    size_t renderedSize() const;
+
+    //! Renders the view into the \p buffer of the given \p capacity.
+    /*!
+        \returns Returns the size of the rendered view. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Returns the string representation of the view.
+    std::string toString() const;
+
+    friend TEXTABLE_EXPORT std::ostream &operator<<(std::ostream &os, const TextableView &view);
+
+private:
+    /// Returns all visible rows, the header rows first.
+    std::vector<RowNumber> visibleRows() const;
+
+    /// Writes the rendered view to the \p os stream row by row.
+    void write(std::ostream &os) const;
+
+    const Textable *m_table;
+    RowNumber m_headerRows;
+
+    /// The visible rows after the header.
+    std::vector<RowNumber> m_rows;
+};
+
+template<typename Predicate>
+TextableView &TextableView::filter(Predicate && predicate)
+{
+    auto end = m_rows.begin();
+    for (auto row : m_rows) {
+        if (predicate(m_table->m_table[row])) {
+            *end++ = row;
+        }
+    }
+    m_rows.erase(end, m_rows.end());
+    return *this;
+}
+
+#endif // !__TEXTABLEVIEW_H__
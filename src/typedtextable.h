@@ -0,0 +1,326 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __TYPEDTEXTABLE_H__
+#define __TYPEDTEXTABLE_H__
+
+#include "renderer.h"
+#include "textable.h"
+#include "unicode.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//! Declares a column of the `TypedTextable` with the value type \p T and the alignment \p A.
+template<typename T, Textable::Align A = Textable::Align::Center>
+struct TypedColumn
+{
+    using Type = T;
+
+    static constexpr Textable::Align align()
+    {
+        return A;
+    }
+};
+
+//! Implements a text table with a schema known at compile time.
+/*!
+    The template parameters declare the columns: either the value types, in which case
+    the cells are centered, or `TypedColumn` with the value type and the alignment.
+
+    Unlike `Textable` every row has all columns, the number of columns is a constant and
+    the conversion of each column value into text is chosen at compile time. The text of
+    all cells is kept in a single buffer and each row is a fixed size record referring to
+    it, so adding a row doesn't allocate per row or per cell containers. The column widths
+    are maintained on the fly.
+
+    The output format is the same as the `Textable` one.
+
+    \example
+        TypedTextable<TypedColumn<std::string, Textable::Align::Left>,
+                      TypedColumn<double, Textable::Align::Right>> table;
+        table.setHeader("Name", "Value");
+        table.addRow("pi", 3.14159);
+        std::cout << table;
+*/
+template<typename... Columns>
+class TypedTextable
+{
+    static_assert(sizeof...(Columns) > 0, "A table should have at least one column");
+
+    template<typename T>
+    struct ColumnTraits
+    {
+        using Type = T;
+
+        static constexpr Textable::Align align()
+        {
+            return Textable::Align::Center;
+        }
+    };
+
+    template<typename T, Textable::Align A>
+    struct ColumnTraits<TypedColumn<T, A>>
+    {
+        using Type = T;
+
+        static constexpr Textable::Align align()
+        {
+            return A;
+        }
+    };
+
+public:
+    using RowNumber    = Textable::RowNumber;
+    using ColumnNumber = Textable::ColumnNumber;
+
+    //! Returns the number of columns.
+    static constexpr ColumnNumber columnCount()
+    {
+        return sizeof...(Columns);
+    }
+
+    //! Sets the header row, that is rendered before all rows.
+    /*!
+        The header has a title per column. It is aligned as the columns are.
+    */
+    template<typename... Titles>
+    void setHeader(const Titles &... titles);
+
+    //! Appends a row with the given \p values, one per column.
+    void addRow(const typename ColumnTraits<Columns>::Type &... values);
+
+    //! Reserves the memory for the given number of \p rows.
+    /*!
+        \param rows        The expected number of rows
+        \param bytesPerRow The expected size of the text of a row in bytes
+    */
+    void reserve(RowNumber rows, size_t bytesPerRow = 0);
+
+    //! Returns the number of rows, without the header.
+    RowNumber rowCount() const;
+
+    //! Returns the content widths of all columns.
+    std::vector<size_t> columnWidths() const;
+
+    //! Returns the size of the rendered table in bytes.
+    size_t renderedSize() const;
+
+    //! Renders the table into the \p buffer of the given \p capacity.
+    /*!
+        \returns Returns the size of the rendered table. Nothing is written if the
+                 capacity is smaller than that.
+    */
+    size_t renderTo(char *buffer, size_t capacity) const;
+
+    //! Returns the string representation of the table.
+    std::string toString() const;
+
+    //! Prints the table into the output stream.
+    template<typename... Ts>
+    friend std::ostream &operator<<(std::ostream &os, const TypedTextable<Ts...> &table);
+
+private:
+    /// A cell text, that is stored in the table text buffer.
+    struct Cell
+    {
+        size_t m_size;
+        size_t m_width;
+    };
+
+    /// A row record. The row cells are stored one after another starting at the offset.
+    struct Record
+    {
+        size_t m_offset;
+        std::array<Cell, sizeof...(Columns)> m_cells;
+    };
+
+    template<typename T>
+    void appendCell(Record &record, ColumnNumber column, const T &value);
+
+    Renderer makeRenderer() const;
+
+    char *writeRecord(char *out, const Renderer &renderer, const Record &record) const;
+
+    std::string m_text;
+    std::vector<Record> m_records;
+    std::array<size_t, sizeof...(Columns)> m_widths{};
+
+    /// The number of bytes all records take in excess of their display width.
+    size_t m_extraSize = 0;
+
+    bool m_hasHeader = false;
+    Record m_header = Record();
+};
+
+template<typename... Columns>
+template<typename... Titles>
+void TypedTextable<Columns...>::setHeader(const Titles &... titles)
+{
+    static_assert(sizeof...(Titles) == sizeof...(Columns), "A title per column is expected");
+
+    // The header text is never removed from the buffer, but it is set only once usually.
+    Record record;
+    record.m_offset = m_text.size();
+    ColumnNumber column = 0;
+    const int expand[] = { (appendCell(record, column++, titles), 0)... };
+    (void)expand;
+
+    if (m_hasHeader) {
+        for (const auto &cell : m_header.m_cells) {
+            m_extraSize -= cell.m_size - cell.m_width;
+        }
+    }
+    m_header = record;
+    m_hasHeader = true;
+}
+
+template<typename... Columns>
+void TypedTextable<Columns...>::addRow(const typename ColumnTraits<Columns>::Type &... values)
+{
+    Record record;
+    record.m_offset = m_text.size();
+    ColumnNumber column = 0;
+    const int expand[] = { (appendCell(record, column++, values), 0)... };
+    (void)expand;
+
+    m_records.push_back(record);
+}
+
+template<typename... Columns>
+template<typename T>
+void TypedTextable<Columns...>::appendCell(Record &record, ColumnNumber column, const T &value)
+{
+    const auto text = Textable::valueToString(value);
+    const auto width = Unicode::displayWidth(text);
+
+    m_text.append(text);
+    record.m_cells[column] = { text.size(), width };
+    m_widths[column] = std::max(m_widths[column], width);
+    m_extraSize += text.size() - width;
+}
+
+template<typename... Columns>
+void TypedTextable<Columns...>::reserve(RowNumber rows, size_t bytesPerRow)
+{
+    m_records.reserve(rows);
+    m_text.reserve(rows * bytesPerRow);
+}
+
+template<typename... Columns>
+typename TypedTextable<Columns...>::RowNumber TypedTextable<Columns...>::rowCount() const
+{
+    return m_records.size();
+}
+
+template<typename... Columns>
+std::vector<size_t> TypedTextable<Columns...>::columnWidths() const
+{
+    return std::vector<size_t>(m_widths.begin(), m_widths.end());
+}
+
+template<typename... Columns>
+Renderer TypedTextable<Columns...>::makeRenderer() const
+{
+    return Renderer(columnWidths());
+}
+
+template<typename... Columns>
+size_t TypedTextable<Columns...>::renderedSize() const
+{
+    const auto lines = m_records.size() + (m_hasHeader ? 1 : 0);
+    if (lines == 0) {
+        return 0;
+    }
+
+    // All lines have the same size, except the bytes of multi-byte characters.
+    size_t lineSize = 1 + 1;
+    for (auto width : m_widths) {
+        lineSize += width + Renderer::padding + 1;
+    }
+    return lineSize * (2 * lines + 1) + m_extraSize;
+}
+
+template<typename... Columns>
+char *TypedTextable<Columns...>::writeRecord(char *out, const Renderer &renderer,
+                                             const Record &record) const
+{
+    static const Textable::Align aligns[] = { ColumnTraits<Columns>::align()... };
+
+    auto data = m_text.data() + record.m_offset;
+    *out++ = '|';
+    for (ColumnNumber c = 0; c < columnCount(); ++c) {
+        const auto &cell = record.m_cells[c];
+        out = renderer.writeCell(out, c, data, cell.m_size, cell.m_width, aligns[c]);
+        data += cell.m_size;
+        *out++ = '|';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+template<typename... Columns>
+size_t TypedTextable<Columns...>::renderTo(char *buffer, size_t capacity) const
+{
+    const auto size = renderedSize();
+    if (size == 0 || size > capacity) {
+        return size;
+    }
+
+    const auto renderer = makeRenderer();
+    auto out = renderer.writeBorder(buffer);
+    if (m_hasHeader) {
+        out = writeRecord(out, renderer, m_header);
+        out = renderer.writeBorder(out);
+    }
+    for (const auto &record : m_records) {
+        out = writeRecord(out, renderer, record);
+        out = renderer.writeBorder(out);
+    }
+    assert(out == buffer + size);
+
+    return size;
+}
+
+template<typename... Columns>
+std::string TypedTextable<Columns...>::toString() const
+{
+    std::string result(renderedSize(), '\0');
+    if (!result.empty()) {
+        renderTo(&result[0], result.size());
+    }
+    return result;
+}
+
+template<typename... Ts>
+std::ostream &operator<<(std::ostream &os, const TypedTextable<Ts...> &table)
+{
+    return os << table.toString();
+}
+
+#endif // !__TYPEDTEXTABLE_H__
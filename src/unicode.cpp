@@ -0,0 +1,494 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#include "unicode.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define TEXTABLE_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#   define TEXTABLE_AVX2
+#   define TEXTABLE_TARGET_AVX2 __attribute__((target("avx2")))
+#   include <immintrin.h>
+#elif defined(_MSC_VER) && defined(__AVX2__)
+#   define TEXTABLE_AVX2
+#   define TEXTABLE_TARGET_AVX2
+#   include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace
+{
+
+/// Defines an inclusive range of code points.
+struct Range
+{
+    std::uint32_t m_first;
+    std::uint32_t m_last;
+};
+
+// Combining marks, format characters and other code points that occupy no columns.
+const Range zeroWidthRanges[] = {
+    { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x05BF, 0x05BF },
+    { 0x05C1, 0x05C2 }, { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x0610, 0x061A },
+    { 0x061C, 0x061C }, { 0x064B, 0x065F }, { 0x0670, 0x0670 }, { 0x06D6, 0x06DC },
+    { 0x06DF, 0x06E4 }, { 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED }, { 0x0711, 0x0711 },
+    { 0x0730, 0x074A }, { 0x07A6, 0x07B0 }, { 0x07EB, 0x07F3 }, { 0x0816, 0x0819 },
+    { 0x081B, 0x0823 }, { 0x0825, 0x0827 }, { 0x0829, 0x082D }, { 0x0859, 0x085B },
+    { 0x08D3, 0x08E1 }, { 0x08E3, 0x0902 }, { 0x093A, 0x093A }, { 0x093C, 0x093C },
+    { 0x0941, 0x0948 }, { 0x094D, 0x094D }, { 0x0951, 0x0957 }, { 0x0962, 0x0963 },
+    { 0x0981, 0x0981 }, { 0x09BC, 0x09BC }, { 0x09C1, 0x09C4 }, { 0x09CD, 0x09CD },
+    { 0x09E2, 0x09E3 }, { 0x0A01, 0x0A02 }, { 0x0A3C, 0x0A3C }, { 0x0A41, 0x0A42 },
+    { 0x0A47, 0x0A48 }, { 0x0A4B, 0x0A4D }, { 0x0A51, 0x0A51 }, { 0x0A70, 0x0A71 },
+    { 0x0A75, 0x0A75 }, { 0x0A81, 0x0A82 }, { 0x0ABC, 0x0ABC }, { 0x0AC1, 0x0AC5 },
+    { 0x0AC7, 0x0AC8 }, { 0x0ACD, 0x0ACD }, { 0x0AE2, 0x0AE3 }, { 0x0B01, 0x0B01 },
+    { 0x0B3C, 0x0B3C }, { 0x0B3F, 0x0B3F }, { 0x0B41, 0x0B44 }, { 0x0B4D, 0x0B4D },
+    { 0x0B56, 0x0B56 }, { 0x0B62, 0x0B63 }, { 0x0B82, 0x0B82 }, { 0x0BC0, 0x0BC0 },
+    { 0x0BCD, 0x0BCD }, { 0x0C00, 0x0C00 }, { 0x0C3E, 0x0C40 }, { 0x0C46, 0x0C48 },
+    { 0x0C4A, 0x0C4D }, { 0x0C55, 0x0C56 }, { 0x0C62, 0x0C63 }, { 0x0C81, 0x0C81 },
+    { 0x0CBC, 0x0CBC }, { 0x0CBF, 0x0CBF }, { 0x0CC6, 0x0CC6 }, { 0x0CCC, 0x0CCD },
+    { 0x0CE2, 0x0CE3 }, { 0x0D00, 0x0D01 }, { 0x0D41, 0x0D44 }, { 0x0D4D, 0x0D4D },
+    { 0x0D62, 0x0D63 }, { 0x0DCA, 0x0DCA }, { 0x0DD2, 0x0DD4 }, { 0x0DD6, 0x0DD6 },
+    { 0x0E31, 0x0E31 }, { 0x0E34, 0x0E3A }, { 0x0E47, 0x0E4E }, { 0x0EB1, 0x0EB1 },
+    { 0x0EB4, 0x0EBC }, { 0x0EC8, 0x0ECD }, { 0x0F18, 0x0F19 }, { 0x0F35, 0x0F35 },
+    { 0x0F37, 0x0F37 }, { 0x0F39, 0x0F39 }, { 0x0F71, 0x0F7E }, { 0x0F80, 0x0F84 },
+    { 0x0F86, 0x0F87 }, { 0x0F8D, 0x0FBC }, { 0x0FC6, 0x0FC6 }, { 0x102D, 0x1030 },
+    { 0x1032, 0x1037 }, { 0x1039, 0x103A }, { 0x103D, 0x103E }, { 0x1058, 0x1059 },
+    { 0x105E, 0x1060 }, { 0x1071, 0x1074 }, { 0x1082, 0x1082 }, { 0x1085, 0x1086 },
+    { 0x108D, 0x108D }, { 0x109D, 0x109D }, { 0x1160, 0x11FF }, { 0x135D, 0x135F },
+    { 0x1712, 0x1714 }, { 0x1732, 0x1734 }, { 0x1752, 0x1753 }, { 0x1772, 0x1773 },
+    { 0x17B4, 0x17B5 }, { 0x17B7, 0x17BD }, { 0x17C6, 0x17C6 }, { 0x17C9, 0x17D3 },
+    { 0x17DD, 0x17DD }, { 0x180B, 0x180E }, { 0x1885, 0x1886 }, { 0x18A9, 0x18A9 },
+    { 0x1920, 0x1922 }, { 0x1927, 0x1928 }, { 0x1932, 0x1932 }, { 0x1939, 0x193B },
+    { 0x1A17, 0x1A18 }, { 0x1A1B, 0x1A1B }, { 0x1A56, 0x1A56 }, { 0x1A58, 0x1A5E },
+    { 0x1A60, 0x1A60 }, { 0x1A62, 0x1A62 }, { 0x1A65, 0x1A6C }, { 0x1A73, 0x1A7C },
+    { 0x1A7F, 0x1A7F }, { 0x1AB0, 0x1AFF }, { 0x1B00, 0x1B03 }, { 0x1B34, 0x1B34 },
+    { 0x1B36, 0x1B3A }, { 0x1B3C, 0x1B3C }, { 0x1B42, 0x1B42 }, { 0x1B6B, 0x1B73 },
+    { 0x1B80, 0x1B81 }, { 0x1BA2, 0x1BA5 }, { 0x1BA8, 0x1BA9 }, { 0x1BAB, 0x1BAD },
+    { 0x1BE6, 0x1BE6 }, { 0x1BE8, 0x1BE9 }, { 0x1BED, 0x1BED }, { 0x1BEF, 0x1BF1 },
+    { 0x1C2C, 0x1C33 }, { 0x1C36, 0x1C37 }, { 0x1CD0, 0x1CD2 }, { 0x1CD4, 0x1CE0 },
+    { 0x1CE2, 0x1CE8 }, { 0x1CED, 0x1CED }, { 0x1CF4, 0x1CF4 }, { 0x1CF8, 0x1CF9 },
+    { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F }, { 0x202A, 0x202E }, { 0x2060, 0x2064 },
+    { 0x20D0, 0x20F0 }, { 0x2CEF, 0x2CF1 }, { 0x2D7F, 0x2D7F }, { 0x2DE0, 0x2DFF },
+    { 0x302A, 0x302D }, { 0x3099, 0x309A }, { 0xA66F, 0xA672 }, { 0xA674, 0xA67D },
+    { 0xA69E, 0xA69F }, { 0xA6F0, 0xA6F1 }, { 0xA802, 0xA802 }, { 0xA806, 0xA806 },
+    { 0xA80B, 0xA80B }, { 0xA825, 0xA826 }, { 0xA8C4, 0xA8C5 }, { 0xA8E0, 0xA8F1 },
+    { 0xA8FF, 0xA8FF }, { 0xA926, 0xA92D }, { 0xA947, 0xA951 }, { 0xA980, 0xA982 },
+    { 0xA9B3, 0xA9B3 }, { 0xA9B6, 0xA9B9 }, { 0xA9BC, 0xA9BD }, { 0xA9E5, 0xA9E5 },
+    { 0xAA29, 0xAA2E }, { 0xAA31, 0xAA32 }, { 0xAA35, 0xAA36 }, { 0xAA43, 0xAA43 },
+    { 0xAA4C, 0xAA4C }, { 0xAA7C, 0xAA7C }, { 0xAAB0, 0xAAB0 }, { 0xAAB2, 0xAAB4 },
+    { 0xAAB7, 0xAAB8 }, { 0xAABE, 0xAABF }, { 0xAAC1, 0xAAC1 }, { 0xAAEC, 0xAAED },
+    { 0xAAF6, 0xAAF6 }, { 0xABE5, 0xABE5 }, { 0xABE8, 0xABE8 }, { 0xABED, 0xABED },
+    { 0xD7B0, 0xD7FF }, { 0xFB1E, 0xFB1E }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F },
+    { 0xFEFF, 0xFEFF }, { 0xFFF9, 0xFFFB }, { 0x101FD, 0x101FD }, { 0x102E0, 0x102E0 },
+    { 0x10376, 0x1037A }, { 0x10A01, 0x10A03 }, { 0x10A05, 0x10A06 }, { 0x10A0C, 0x10A0F },
+    { 0x10A38, 0x10A3A }, { 0x10A3F, 0x10A3F }, { 0x10AE5, 0x10AE6 }, { 0x10D24, 0x10D27 },
+    { 0x10F46, 0x10F50 }, { 0x11001, 0x11001 }, { 0x11038, 0x11046 }, { 0x1107F, 0x11081 },
+    { 0x110B3, 0x110B6 }, { 0x110B9, 0x110BA }, { 0x11100, 0x11102 }, { 0x11127, 0x1112B },
+    { 0x1112D, 0x11134 }, { 0x11173, 0x11173 }, { 0x11180, 0x11181 }, { 0x111B6, 0x111BE },
+    { 0x1D167, 0x1D169 }, { 0x1D173, 0x1D182 }, { 0x1D185, 0x1D18B }, { 0x1D1AA, 0x1D1AD },
+    { 0x1E000, 0x1E02A }, { 0x1E8D0, 0x1E8D6 }, { 0x1E944, 0x1E94A }, { 0xE0001, 0xE0001 },
+    { 0xE0020, 0xE007F }, { 0xE0100, 0xE01EF }
+};
+
+// East Asian Wide (W) and Fullwidth (F) code points that occupy two columns.
+const Range wideRanges[] = {
+    { 0x1100, 0x115F }, { 0x231A, 0x231B }, { 0x2329, 0x232A }, { 0x23E9, 0x23EC },
+    { 0x23F0, 0x23F0 }, { 0x23F3, 0x23F3 }, { 0x25FD, 0x25FE }, { 0x2614, 0x2615 },
+    { 0x2648, 0x2653 }, { 0x267F, 0x267F }, { 0x2693, 0x2693 }, { 0x26A1, 0x26A1 },
+    { 0x26AA, 0x26AB }, { 0x26BD, 0x26BE }, { 0x26C4, 0x26C5 }, { 0x26CE, 0x26CE },
+    { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA }, { 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 },
+    { 0x26FA, 0x26FA }, { 0x26FD, 0x26FD }, { 0x2705, 0x2705 }, { 0x270A, 0x270B },
+    { 0x2728, 0x2728 }, { 0x274C, 0x274C }, { 0x274E, 0x274E }, { 0x2753, 0x2755 },
+    { 0x2757, 0x2757 }, { 0x2795, 0x2797 }, { 0x27B0, 0x27B0 }, { 0x27BF, 0x27BF },
+    { 0x2B1B, 0x2B1C }, { 0x2B50, 0x2B50 }, { 0x2B55, 0x2B55 }, { 0x2E80, 0x2E99 },
+    { 0x2E9B, 0x2EF3 }, { 0x2F00, 0x2FD5 }, { 0x2FF0, 0x2FFB }, { 0x3000, 0x303E },
+    { 0x3041, 0x3096 }, { 0x309B, 0x30FF }, { 0x3105, 0x312F }, { 0x3131, 0x318E },
+    { 0x3190, 0x31E3 }, { 0x31F0, 0x321E }, { 0x3220, 0x3247 }, { 0x3250, 0x4DBF },
+    { 0x4E00, 0xA48C }, { 0xA490, 0xA4C6 }, { 0xA960, 0xA97C }, { 0xAC00, 0xD7A3 },
+    { 0xF900, 0xFAFF }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE52 }, { 0xFE54, 0xFE66 },
+    { 0xFE68, 0xFE6B }, { 0xFF01, 0xFF60 }, { 0xFFE0, 0xFFE6 }, { 0x16FE0, 0x16FE4 },
+    { 0x16FF0, 0x16FF1 }, { 0x17000, 0x187F7 }, { 0x18800, 0x18CD5 }, { 0x18D00, 0x18D08 },
+    { 0x1B000, 0x1B11E }, { 0x1B150, 0x1B152 }, { 0x1B164, 0x1B167 }, { 0x1B170, 0x1B2FB },
+    { 0x1F004, 0x1F004 }, { 0x1F0CF, 0x1F0CF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A },
+    { 0x1F200, 0x1F202 }, { 0x1F210, 0x1F23B }, { 0x1F240, 0x1F248 }, { 0x1F250, 0x1F251 },
+    { 0x1F260, 0x1F265 }, { 0x1F300, 0x1F320 }, { 0x1F32D, 0x1F335 }, { 0x1F337, 0x1F37C },
+    { 0x1F37E, 0x1F393 }, { 0x1F3A0, 0x1F3CA }, { 0x1F3CF, 0x1F3D3 }, { 0x1F3E0, 0x1F3F0 },
+    { 0x1F3F4, 0x1F3F4 }, { 0x1F3F8, 0x1F43E }, { 0x1F440, 0x1F440 }, { 0x1F442, 0x1F4FC },
+    { 0x1F4FF, 0x1F53D }, { 0x1F54B, 0x1F54E }, { 0x1F550, 0x1F567 }, { 0x1F57A, 0x1F57A },
+    { 0x1F595, 0x1F596 }, { 0x1F5A4, 0x1F5A4 }, { 0x1F5FB, 0x1F64F }, { 0x1F680, 0x1F6C5 },
+    { 0x1F6CC, 0x1F6CC }, { 0x1F6D0, 0x1F6D2 }, { 0x1F6D5, 0x1F6D7 }, { 0x1F6EB, 0x1F6EC },
+    { 0x1F6F4, 0x1F6FC }, { 0x1F7E0, 0x1F7EB }, { 0x1F90C, 0x1F93A }, { 0x1F93C, 0x1F945 },
+    { 0x1F947, 0x1F978 }, { 0x1F97A, 0x1F9CB }, { 0x1F9CD, 0x1F9FF }, { 0x1FA70, 0x1FA74 },
+    { 0x1FA78, 0x1FA7A }, { 0x1FA80, 0x1FA86 }, { 0x1FA90, 0x1FAA8 }, { 0x1FAB0, 0x1FAB6 },
+    { 0x1FAC0, 0x1FAC2 }, { 0x1FAD0, 0x1FAD6 }, { 0x20000, 0x2FFFD }, { 0x30000, 0x3FFFD }
+};
+
+template<size_t N>
+bool contains(const Range (&ranges)[N], std::uint32_t codePoint)
+{
+    if (codePoint < ranges[0].m_first || codePoint > ranges[N - 1].m_last) {
+        return false;
+    }
+    // Find the first range that ends at or after the code point.
+    const auto range = std::lower_bound(ranges, ranges + N, codePoint,
+                                        [](const Range &r, std::uint32_t cp) {
+                                            return r.m_last < cp;
+                                        });
+    return range != ranges + N && range->m_first <= codePoint;
+}
+
+/// Implements a two level lookup table of the code point widths.
+/*!
+    Code points are grouped in blocks of 256. A block with code points of the same
+    width (the vast majority) stores the width itself, whereas a block with mixed widths
+    refers to a separate table of per code point widths. The table is built once from
+    the range tables above.
+*/
+class WidthTable
+{
+public:
+    WidthTable()
+        :
+            m_blocks(blockCount, 1)
+    {
+        // Only blocks that intersect the ranges can have code points of different widths.
+        std::vector<bool> touched(blockCount, false);
+        touch(zeroWidthRanges, touched);
+        touch(wideRanges, touched);
+
+        for (std::uint32_t block = 0; block < blockCount; ++block) {
+            if (!touched[block]) {
+                continue;
+            }
+            const auto first = block << blockBits;
+            const auto width = rangeWidth(first);
+            for (auto codePoint = first + 1; codePoint < first + blockSize; ++codePoint) {
+                if (rangeWidth(codePoint) != width) {
+                    m_blocks[block] = static_cast<std::uint16_t>(mixed + m_details.size() / blockSize);
+                    for (auto cp = first; cp < first + blockSize; ++cp) {
+                        m_details.push_back(static_cast<unsigned char>(rangeWidth(cp)));
+                    }
+                    break;
+                }
+            }
+            if (m_blocks[block] < mixed) {
+                m_blocks[block] = static_cast<std::uint16_t>(width);
+            }
+        }
+    }
+
+    int width(std::uint32_t codePoint) const
+    {
+        const auto block = m_blocks[codePoint >> blockBits];
+        if (block < mixed) {
+            return block;
+        }
+        return m_details[(block - mixed) * blockSize + (codePoint & (blockSize - 1))];
+    }
+
+private:
+    static const unsigned blockBits = 8;
+    static const std::uint32_t blockSize = 1U << blockBits;
+    static const std::uint32_t blockCount = 0x110000 >> blockBits;
+    static const std::uint16_t mixed = 3;
+
+    template<size_t N>
+    static void touch(const Range (&ranges)[N], std::vector<bool> &touched)
+    {
+        for (const auto &range : ranges) {
+            for (auto block = range.m_first >> blockBits; block <= range.m_last >> blockBits; ++block) {
+                touched[block] = true;
+            }
+        }
+    }
+
+    static int rangeWidth(std::uint32_t codePoint)
+    {
+        if (contains(zeroWidthRanges, codePoint)) {
+            return 0;
+        }
+        if (contains(wideRanges, codePoint)) {
+            return 2;
+        }
+        return 1;
+    }
+
+    std::vector<std::uint16_t> m_blocks;
+    std::vector<unsigned char> m_details;
+};
+
+const WidthTable &widthTable()
+{
+    static const WidthTable table;
+    return table;
+}
+
+/// Returns the number of trailing zero bits of a non-zero \p value.
+inline unsigned trailingZeros(std::uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+}
+
+size_t asciiLengthScalar(const char *data, size_t size)
+{
+    static const std::uint64_t highBits = 0x8080808080808080ULL;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, data + i, sizeof(chunk));
+        if (chunk & highBits) {
+            break;
+        }
+    }
+    while (i < size && static_cast<unsigned char>(data[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(TEXTABLE_SSE2)
+size_t asciiLengthSse2(const char *data, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(chunk));
+        if (mask != 0) {
+            return i + trailingZeros(mask);
+        }
+    }
+    return i + asciiLengthScalar(data + i, size - i);
+}
+#endif
+
+#if defined(TEXTABLE_AVX2)
+TEXTABLE_TARGET_AVX2
+size_t asciiLengthAvx2(const char *data, size_t size)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(chunk));
+        if (mask != 0) {
+            return i + trailingZeros(mask);
+        }
+    }
+    return i + asciiLengthScalar(data + i, size - i);
+}
+#endif
+
+using AsciiLengthFunction = size_t (*)(const char *, size_t);
+
+AsciiLengthFunction selectAsciiLength()
+{
+#if defined(TEXTABLE_AVX2)
+#   if defined(_MSC_VER)
+    // Compiled with /arch:AVX2, so the instructions are available.
+    return asciiLengthAvx2;
+#   else
+    if (__builtin_cpu_supports("avx2")) {
+        return asciiLengthAvx2;
+    }
+#   endif
+#endif
+#if defined(TEXTABLE_SSE2)
+    return asciiLengthSse2;
+#else
+    return asciiLengthScalar;
+#endif
+}
+
+size_t asciiLengthImpl(const char *data, size_t size)
+{
+    // The implementation is selected once, on the first use.
+    static const auto function = selectAsciiLength();
+    return function(data, size);
+}
+
+/// Decodes a single non-ASCII UTF-8 sequence starting at \p data.
+/*!
+    Returns the number of consumed bytes. For malformed sequences consumes
+    a single byte and reports the U+FFFD replacement character.
+*/
+inline size_t decode(const unsigned char *data, size_t size, std::uint32_t &codePoint)
+{
+    static const std::uint32_t replacement = 0xFFFD;
+
+    const auto lead = data[0];
+    size_t length = 0;
+    std::uint32_t minimum = 0;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        codePoint = lead & 0x1F;
+        minimum = 0x80;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        codePoint = lead & 0x0F;
+        minimum = 0x800;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        codePoint = lead & 0x07;
+        minimum = 0x10000;
+    } else {
+        codePoint = replacement;
+        return 1;
+    }
+
+    if (length > size) {
+        codePoint = replacement;
+        return 1;
+    }
+
+    for (size_t i = 1; i < length; ++i) {
+        if ((data[i] & 0xC0) != 0x80) {
+            codePoint = replacement;
+            return 1;
+        }
+        codePoint = (codePoint << 6) | (data[i] & 0x3F);
+    }
+
+    // Reject overlong encodings, surrogates and out of range values.
+    if (codePoint < minimum || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) {
+        codePoint = replacement;
+        return 1;
+    }
+    return length;
+}
+
+} // namespace
+
+size_t Unicode::displayWidth(const std::string &string)
+{
+    return displayWidth(string.data(), string.size());
+}
+
+size_t Unicode::displayWidth(const char *data, size_t size)
+{
+    const auto bytes = reinterpret_cast<const unsigned char *>(data);
+    size_t width = 0;
+    size_t i = 0;
+    while (i < size) {
+        // Every ASCII character occupies a single column.
+        const auto ascii = asciiLengthImpl(data + i, size - i);
+        width += ascii;
+        i += ascii;
+
+        if (i == size) {
+            break;
+        }
+
+        const auto &table = widthTable();
+        do {
+            std::uint32_t codePoint = 0;
+            i += decode(bytes + i, size - i, codePoint);
+            // There are no combining or wide characters before the combining diacritical marks block.
+            width += codePoint < 0x300 ? 1 : table.width(codePoint);
+            // Short ASCII runs, like spaces between words, are counted in place.
+            while (i < size && bytes[i] < 0x80 && (i + 1 == size || bytes[i + 1] >= 0x80)) {
+                ++width;
+                ++i;
+            }
+        } while (i < size && bytes[i] >= 0x80);
+    }
+    return width;
+}
+
+size_t Unicode::prefixSize(const char *data, size_t size, size_t maxWidth, size_t &width)
+{
+    const auto bytes = reinterpret_cast<const unsigned char *>(data);
+    width = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (bytes[i] < 0x80) {
+            // Take the whole ASCII run that fits at once.
+            const auto ascii = std::min(asciiLengthImpl(data + i, size - i), maxWidth - width);
+            if (ascii == 0) {
+                break;
+            }
+            width += ascii;
+            i += ascii;
+            continue;
+        }
+
+        std::uint32_t codePoint = 0;
+        const auto length = decode(bytes + i, size - i, codePoint);
+        const auto codePointWidth = static_cast<size_t>(Unicode::codePointWidth(codePoint));
+        if (width + codePointWidth > maxWidth) {
+            break;
+        }
+        width += codePointWidth;
+        i += length;
+    }
+    return i;
+}
+
+size_t Unicode::codePointPrefix(const char *data, size_t size, size_t maxSize)
+{
+    if (size <= maxSize) {
+        return size;
+    }
+
+    // Step back over the continuation bytes of the code point that is cut.
+    const auto bytes = reinterpret_cast<const unsigned char *>(data);
+    auto i = maxSize;
+    while (i > 0 && maxSize - i < 3 && (bytes[i] & 0xC0) == 0x80) {
+        --i;
+    }
+    return (bytes[i] & 0xC0) == 0x80 ? maxSize : i;
+}
+
+size_t Unicode::asciiLength(const char *data, size_t size)
+{
+    return asciiLengthImpl(data, size);
+}
+
+int Unicode::codePointWidth(std::uint32_t codePoint)
+{
+    // There are no combining or wide characters before the combining diacritical marks block.
+    if (codePoint < 0x300) {
+        return 1;
+    }
+    if (codePoint > 0x10FFFF) {
+        return 1;
+    }
+
+    return widthTable().width(codePoint);
+}
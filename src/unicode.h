@@ -0,0 +1,75 @@
+/**********************************************************************************
+*  MIT License                                                                    *
+*                                                                                 *
+*  Copyright (c) 2020 Vahan Aghajanyan <vahancho@gmail.com>                       *
+*                                                                                 *
+*  Permission is hereby granted, free of charge, to any person obtaining a copy   *
+*  of this software and associated documentation files (the "Software"), to deal  *
+*  in the Software without restriction, including without limitation the rights   *
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+*  copies of the Software, and to permit persons to whom the Software is          *
+*  furnished to do so, subject to the following conditions:                       *
+*                                                                                 *
+*  The above copyright notice and this permission notice shall be included in all *
+*  copies or substantial portions of the Software.                                *
+*                                                                                 *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+*  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+*  SOFTWARE.                                                                      *
+***********************************************************************************/
+
+#ifndef __UNICODE_H__
+#define __UNICODE_H__
+
+#include "export.h"
+
+#include <cstdint>
+#include <string>
+
+//! Implements the display width calculation of UTF-8 encoded strings.
+/*!
+    The display width is the number of terminal columns a string occupies. It differs
+    from both the number of bytes and the number of code points: East Asian wide and
+    full width characters (CJK ideographs, Hangul syllables, most emoji) occupy two
+    columns, while combining marks and other zero width characters occupy none.
+
+    The calculation doesn't depend on the process locale. Pure ASCII runs are detected
+    with SIMD instructions (AVX2 or SSE2 where available, with a scalar fallback) and
+    cost a fraction of a cycle per byte. Non-ASCII code points are classified with
+    compact range tables. Malformed UTF-8 bytes are counted as one column each.
+*/
+class TEXTABLE_EXPORT Unicode
+{
+public:
+    //! Returns the display width of the UTF-8 encoded \p string.
+    static size_t displayWidth(const std::string &string);
+
+    //! Returns the display width of the UTF-8 encoded string of \p size bytes.
+    static size_t displayWidth(const char *data, size_t size);
+
+    //! Returns the length of the leading pure ASCII part of the given data.
+    static size_t asciiLength(const char *data, size_t size);
+
+    //! Returns the size in bytes of the longest prefix that fits into \p maxWidth columns.
+    /*!
+        Zero width characters that follow the prefix are included too, so that
+        combining marks are not separated from their base characters.
+        \param data     The UTF-8 encoded string
+        \param size     The size of the string in bytes
+        \param maxWidth The maximum display width of the prefix
+        \param width    Receives the display width of the prefix
+    */
+    static size_t prefixSize(const char *data, size_t size, size_t maxWidth, size_t &width);
+
+    //! Returns the size of the longest prefix of at most \p maxSize bytes that doesn't split a code point.
+    static size_t codePointPrefix(const char *data, size_t size, size_t maxSize);
+
+    //! Returns the display width (0, 1 or 2) of a single \p codePoint.
+    static int codePointWidth(std::uint32_t codePoint);
+};
+
+#endif // !__UNICODE_H__
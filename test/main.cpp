@@ -22,10 +22,84 @@
 *  SOFTWARE.                                                                      *
 ***********************************************************************************/
 
+#include "chunkedrenderer.h"
+#include "columnartextable.h"
+#include "csvreader.h"
+#include "lazytextable.h"
+#include "mappedtextable.h"
+#include "parallel.h"
+#include "sparsetextable.h"
+#include "tablewriter.h"
 #include "textable.h"
+#include "textablebuilder.h"
+#include "textableview.h"
+#include "typedtextable.h"
+#include "unicode.h"
 
-#include <clocale>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#if !defined(_WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/// The number of the operator new calls.
+static std::atomic<size_t> allocationCount{ 0 };
+
+// The replaced allocation functions are built on malloc() and free(). GCC sees free()
+// of the pointers returned by operator new once the operators are inlined.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (auto pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#   pragma GCC diagnostic pop
+#endif
 
 struct TableObject
 {
@@ -214,6 +288,18 @@ TEST(General, EmptyTable)
     EXPECT_EQ(textable.toString(), "");
 }
 
+TEST(General, EmptyCells)
+{
+    Textable textable;
+    textable.setCell(0, 2, Textable::Align::Left, "");
+    EXPECT_EQ(textable.columnWidths(), (std::vector<size_t>{ 0, 0, 0 }));
+    EXPECT_EQ(textable.toString(), "+--+--+--+\n|  |  |  |\n+--+--+--+\n");
+
+    textable.setRow(1, Textable::Align::Left, std::vector<std::string>{ "a", "", "", "" });
+    EXPECT_EQ(textable.toString(), "+---+--+--+--+\n|   |  |  |  |\n+---+--+--+--+\n"
+                                   "|a  |  |  |  |\n+---+--+--+--+\n");
+}
+
 TEST(General, Alignment)
 {
     Textable textable;
@@ -243,11 +329,1600 @@ TEST(General, Alignment)
     EXPECT_EQ(textable.toString(), expected);
 }
 
-int main(int argc, char**argv)
+TEST(General, ColumnCountShrink)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Center, std::vector<int>{ 1, 2, 3 });
+    textable.setRow(1, Textable::Align::Center, std::vector<int>{ 1, 2 });
+    EXPECT_EQ(textable.rowCount(), 2);
+    EXPECT_EQ(textable.columnCount(), 3);
+
+    textable.setRow(0, Textable::Align::Center, std::vector<int>{ 1 });
+    EXPECT_EQ(textable.columnCount(), 2);
+
+    textable.setRow(1, Textable::Align::Center, Textable::Row{ { "1" } });
+    EXPECT_EQ(textable.columnCount(), 1);
+
+    textable.setCell(3, 4, Textable::Align::Center, 5);
+    EXPECT_EQ(textable.rowCount(), 4);
+    EXPECT_EQ(textable.columnCount(), 5);
+    EXPECT_EQ(textable.toString(), "+---+--+--+--+---+\n"
+                                   "| 1 |  |  |  |   |\n"
+                                   "+---+--+--+--+---+\n"
+                                   "| 1 |  |  |  |   |\n"
+                                   "+---+--+--+--+---+\n"
+                                   "|   |  |  |  |   |\n"
+                                   "+---+--+--+--+---+\n"
+                                   "|   |  |  |  | 5 |\n"
+                                   "+---+--+--+--+---+\n");
+}
+
+TEST(General, ColumnWidthShrink)
+{
+    Textable textable;
+    textable.setColumn(0, Textable::Align::Left, std::vector<std::string>{ "Long value", "Long value", "Short" });
+    textable.setCell(0, 1, Textable::Align::Left, "Text");
+    EXPECT_EQ(textable.toString(), "+------------+------+\n"
+                                   "|Long value  |Text  |\n"
+                                   "+------------+------+\n"
+                                   "|Long value  |      |\n"
+                                   "+------------+------+\n"
+                                   "|Short       |      |\n"
+                                   "+------------+------+\n");
+
+    textable.setCell(0, 0, Textable::Align::Left, "Value");
+    EXPECT_EQ(textable.toString(), "+------------+------+\n"
+                                   "|Value       |Text  |\n"
+                                   "+------------+------+\n"
+                                   "|Long value  |      |\n"
+                                   "+------------+------+\n"
+                                   "|Short       |      |\n"
+                                   "+------------+------+\n");
+
+    textable.setRow(1, Textable::Align::Left, "Val", "Text value");
+    EXPECT_EQ(textable.toString(), "+-------+------------+\n"
+                                   "|Value  |Text        |\n"
+                                   "+-------+------------+\n"
+                                   "|Val    |Text value  |\n"
+                                   "+-------+------------+\n"
+                                   "|Short  |            |\n"
+                                   "+-------+------------+\n");
+
+    textable.setRow(1, Textable::Align::Left, std::vector<std::string>{ "V" });
+    EXPECT_EQ(textable.toString(), "+-------+------+\n"
+                                   "|Value  |Text  |\n"
+                                   "+-------+------+\n"
+                                   "|V      |      |\n"
+                                   "+-------+------+\n"
+                                   "|Short  |      |\n"
+                                   "+-------+------+\n");
+}
+
+TEST(General, ValueConversion)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Center, 0, -1, 42L, std::numeric_limits<long long>::min(),
+                    std::numeric_limits<unsigned long long>::max(), static_cast<short>(-7), 'x',
+                    static_cast<unsigned char>('y'), true, false);
+    EXPECT_EQ(textable.cellData(0, 0), "0");
+    EXPECT_EQ(textable.cellData(0, 1), "-1");
+    EXPECT_EQ(textable.cellData(0, 2), "42");
+    EXPECT_EQ(textable.cellData(0, 3), "-9223372036854775808");
+    EXPECT_EQ(textable.cellData(0, 4), "18446744073709551615");
+    EXPECT_EQ(textable.cellData(0, 5), "-7");
+    EXPECT_EQ(textable.cellData(0, 6), "x");
+    EXPECT_EQ(textable.cellData(0, 7), "y");
+    EXPECT_EQ(textable.cellData(0, 8), "true");
+    EXPECT_EQ(textable.cellData(0, 9), "false");
+
+    const std::vector<double> values{ 0.0, 1.1, -0.5, 1e20, 1234567.0, 0.0001, 123456.0, 1.0 / 3,
+                                      std::numeric_limits<double>::infinity() };
+    textable.setRow(1, Textable::Align::Center, values);
+    for (size_t c = 0; c < values.size(); ++c) {
+        std::ostringstream stream;
+        stream << values[c];
+        EXPECT_EQ(textable.cellData(1, c), stream.str());
+    }
+    EXPECT_EQ(textable.cellData(1, 3), "1e+20");
+    EXPECT_EQ(textable.cellData(1, 4), "1.23457e+06");
+
+    textable.setRow(2, Textable::Align::Center, 2.2f, 12.29f, 1.5L);
+    EXPECT_EQ(textable.cellData(2, 0), "2.2");
+    EXPECT_EQ(textable.cellData(2, 1), "12.29");
+    EXPECT_EQ(textable.cellData(2, 2), "1.5");
+
+    const char *text = "text";
+    const char *null = nullptr;
+    std::string string("string");
+    textable.setRow(3, Textable::Align::Center, text, null, string, std::string("temporary"));
+    EXPECT_EQ(textable.cellData(3, 0), "text");
+    EXPECT_EQ(textable.cellData(3, 1), "");
+    EXPECT_EQ(textable.cellData(3, 2), "string");
+    EXPECT_EQ(textable.cellData(3, 3), "temporary");
+    EXPECT_EQ(string, "string");
+}
+
+TEST(General, MoveIngestion)
+{
+    static const size_t cellCount = 100;
+
+    // Long strings, that don't fit the small string buffer.
+    const std::vector<std::string> values(cellCount, std::string(64, 'x'));
+
+    // Give the table its shape first, so that only the row itself may allocate.
+    Textable textable;
+    textable.setRow(0, Textable::Align::Left, values);
+    textable.setRow(1, Textable::Align::Left, values);
+    textable.setRow(2, Textable::Align::Left, values);
+
+    auto moved = values;
+    auto before = allocationCount.load();
+    textable.setRow(1, Textable::Align::Left, std::move(moved));
+    EXPECT_LE(allocationCount - before, 1);
+
+    Textable::Row row(values.begin(), values.end());
+    before = allocationCount.load();
+    textable.setRow(2, Textable::Align::Center, std::move(row));
+    EXPECT_EQ(allocationCount - before, 0);
+
+    std::string text(64, 'y');
+    before = allocationCount.load();
+    textable.setCell(0, 5, Textable::Align::Left, std::move(text));
+    EXPECT_EQ(allocationCount - before, 0);
+
+    // Copies allocate per cell.
+    before = allocationCount.load();
+    textable.setRow(1, Textable::Align::Left, values);
+    EXPECT_GE(allocationCount - before, cellCount);
+
+    // Borrowed text is copied into the cell directly.
+    const char borrowed[] = "borrowed text that is longer than the small string buffer";
+    before = allocationCount.load();
+    textable.setCell(0, 6, Textable::Align::Left, borrowed, sizeof(borrowed) - 1);
+    EXPECT_EQ(allocationCount - before, 1);
+
+    std::vector<std::string> column(3, std::string(64, 'z'));
+    before = allocationCount.load();
+    textable.setColumn(7, Textable::Align::Left, std::move(column));
+    EXPECT_EQ(allocationCount - before, 0);
+
+    Textable expected;
+    expected.setRow(0, Textable::Align::Left, values);
+    expected.setRow(1, Textable::Align::Left, values);
+    expected.setRow(2, Textable::Align::Center, values);
+    expected.setCell(0, 5, Textable::Align::Left, std::string(64, 'y'));
+    expected.setCell(0, 6, Textable::Align::Left, borrowed);
+    expected.setColumn(7, Textable::Align::Left, std::vector<std::string>(3, std::string(64, 'z')));
+    EXPECT_EQ(textable.toString(), expected.toString());
+}
+
+TEST(General, BulkIngestion)
+{
+    static const Textable::RowNumber rowCount = 1000;
+    static const Textable::ColumnNumber columnCount = 8;
+
+    // A row allocates its cells once and the table never grows.
+    Textable reserved;
+    reserved.reserve(rowCount, columnCount);
+    const auto before = allocationCount.load();
+    for (Textable::RowNumber r = 0; r < rowCount; ++r) {
+        for (Textable::ColumnNumber c = 0; c < columnCount; ++c) {
+            reserved.setCell(r, c, Textable::Align::Right, static_cast<int>(c));
+        }
+    }
+    EXPECT_EQ(allocationCount - before, rowCount);
+
+    struct Record
+    {
+        std::string m_name;
+        int m_count;
+        double m_value;
+    };
+    const std::vector<Record> records{ { "first", 1, 1.5 }, { u8"второй", 22, -0.25 }, { "third", 333, 1e10 } };
+
+    Textable appended;
+    appended.appendRow(Textable::Align::Left, "Name", "Count", "Value");
+    appended.appendRows(records.begin(), records.end(), Textable::Align::Right,
+                        [](const Record &record) { return record.m_name; },
+                        [](const Record &record) { return record.m_count; },
+                        [](const Record &record) { return record.m_value; });
+    appended.appendRow(Textable::Row{ { "Total", Textable::Align::Left } });
+
+    Textable expected;
+    expected.setRow(0, Textable::Align::Left, "Name", "Count", "Value");
+    for (size_t r = 0; r < records.size(); ++r) {
+        expected.setRow(r + 1, Textable::Align::Right, records[r].m_name, records[r].m_count, records[r].m_value);
+    }
+    expected.setCell(4, 0, Textable::Align::Left, "Total");
+
+    EXPECT_EQ(appended.rowCount(), 5);
+    EXPECT_EQ(appended.columnCount(), 3);
+    EXPECT_EQ(appended.toString(), expected.toString());
+}
+
+TEST(General, WideRowFill)
+{
+    static const Textable::ColumnNumber columnCount = 16384;
+
+    // Filling a row cell by cell grows it geometrically, not one cell at a time.
+    Textable textable;
+    const auto before = allocationCount.load();
+    for (Textable::ColumnNumber c = 0; c < columnCount; ++c) {
+        textable.setCell(0, c, Textable::Align::Left, "x");
+    }
+    EXPECT_LT(allocationCount - before, 100u);
+
+    Textable column;
+    column.setColumn(0, Textable::Align::Left, std::vector<int>(100, 1));
+    const auto columnBefore = allocationCount.load();
+    for (Textable::ColumnNumber c = 1; c < 1000; ++c) {
+        column.setColumn(c, Textable::Align::Left, std::vector<int>(100, 1));
+    }
+    EXPECT_LT(allocationCount - columnBefore, 100u * 100u);
+    EXPECT_EQ(column.columnCount(), 1000);
+}
+
+TEST(General, Clear)
+{
+    const std::vector<std::string> names{ "the first long cell value", "the second long cell value" };
+    const std::vector<std::string> total{ names[0], "total" };
+    auto fill = [&names, &total](Textable &textable) {
+        textable.appendRow(Textable::Align::Left, "Name", "Count", "Value");
+        for (int r = 0; r < 50; ++r) {
+            textable.appendRow(Textable::Align::Left, names[r % 2], r, r * 0.5);
+        }
+        textable.setRow(51, Textable::Align::Right, total);
+        textable.setCell(52, 1, Textable::Align::Left, names[1].data(), names[1].size());
+    };
+
+    Textable textable;
+    textable.setColumnFormat(2, Textable::ColumnFormat{});
+    fill(textable);
+    const auto expected = textable.toString();
+
+    textable.clear();
+    EXPECT_EQ(textable.rowCount(), 0);
+    EXPECT_EQ(textable.columnCount(), 0);
+    EXPECT_TRUE(textable.columnWidths().empty());
+    EXPECT_EQ(textable.toString(), "");
+    EXPECT_NE(textable.columnFormat(2), nullptr);
+
+    // Once the reused strings have grown to the sizes of the values, the table is
+    // populated again without allocations.
+    fill(textable);
+    textable.clear();
+    const auto before = allocationCount.load();
+    fill(textable);
+    EXPECT_EQ(allocationCount - before, 0);
+    EXPECT_EQ(textable.toString(), expected);
+
+    // Overwritten rows don't accumulate.
+    for (int i = 0; i < 10; ++i) {
+        textable.setRow(0, Textable::Align::Left, Textable::Row{ { names[0], Textable::Align::Left } });
+    }
+    textable.clear();
+    fill(textable);
+    EXPECT_EQ(textable.toString(), expected);
+}
+
+TEST(General, MemoryPool)
+{
+    const std::vector<std::string> names{ "the first long cell value", "the second long cell value" };
+    auto fill = [&names](Textable &textable) {
+        textable.appendRow(Textable::Align::Left, "Name", "Count", "Value");
+        for (int r = 0; r < 50; ++r) {
+            textable.appendRow(Textable::Align::Left, names[r % 2], r, r * 0.5);
+        }
+        textable.setCell(51, 1, Textable::Align::Left, names[1].data(), names[1].size());
+    };
+
+    Textable expected;
+    fill(expected);
+
+    // The tables of a pool take the memory of the previous ones, so that a new table
+    // per request doesn't allocate.
+    Textable::MemoryPool pool;
+    for (int i = 0; i < 2; ++i) {
+        Textable textable(pool);
+        fill(textable);
+    }
+    const auto before = allocationCount.load();
+    {
+        Textable textable(pool);
+        fill(textable);
+        EXPECT_EQ(allocationCount - before, 0);
+        EXPECT_EQ(textable.toString(), expected.toString());
+    }
+
+    // The copied, moved and spliced tables keep the pool.
+    Textable textable(pool);
+    fill(textable);
+    auto copy = textable;
+    Textable moved(std::move(copy));
+    EXPECT_EQ(moved.toString(), expected.toString());
+    moved.splice(std::move(textable));
+    EXPECT_EQ(textable.rowCount(), 0);
+    fill(textable);
+    EXPECT_EQ(textable.toString(), expected.toString());
+}
+
+TEST(General, RenderTo)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Left, u8"Fünf", "abc");
+    textable.setCell(1, 1, Textable::Align::Right, 1);
+
+    const std::string expected(u8"+------+-----+\n"
+                               u8"|Fünf  |abc  |\n"
+                               u8"+------+-----+\n"
+                               u8"|      |    1|\n"
+                               u8"+------+-----+\n");
+    EXPECT_EQ(textable.renderedSize(), expected.size());
+    EXPECT_EQ(textable.columnWidths(), (std::vector<size_t>{ 4, 3 }));
+
+    std::string buffer(expected.size() - 1, '#');
+    EXPECT_EQ(textable.renderTo(&buffer[0], buffer.size()), expected.size());
+    EXPECT_EQ(buffer, std::string(expected.size() - 1, '#'));
+
+    buffer.resize(expected.size() + 1, '#');
+    EXPECT_EQ(textable.renderTo(&buffer[0], buffer.size()), expected.size());
+    EXPECT_EQ(buffer, expected + '#');
+
+    std::ostringstream stream;
+    stream << textable;
+    EXPECT_EQ(stream.str(), expected);
+
+    Textable empty;
+    EXPECT_EQ(empty.renderedSize(), 0);
+    EXPECT_EQ(empty.renderTo(nullptr, 0), 0);
+}
+
+TEST(General, WindowRender)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Center, "Id", "Name", "Value", "Note");
+    for (int r = 1; r < 20; ++r) {
+        textable.setRow(r, Textable::Align::Right, r, std::string(r % 5, 'n'), r * 1.5, r % 3 ? "" : "third");
+    }
+
+    auto lines = [](const std::string &string) {
+        std::vector<std::string> result;
+        std::istringstream stream(string);
+        for (std::string line; std::getline(stream, line);) {
+            result.push_back(line);
+        }
+        return result;
+    };
+    const auto full = lines(textable.toString());
+
+    // A page with the repeated header.
+    Textable::Window window;
+    window.m_beginRow = 7;
+    window.m_endRow = 10;
+    window.m_headerRows = 1;
+    const auto page = textable.toString(window);
+    EXPECT_EQ(textable.renderedSize(window), page.size());
+    EXPECT_EQ(lines(page), (std::vector<std::string>{ full[0], full[1], full[2], full[15], full[16],
+                                                      full[17], full[18], full[19], full[20] }));
+
+    // The columns in the middle, the window starts within the header.
+    window.m_beginRow = 0;
+    window.m_endRow = 2;
+    window.m_beginColumn = 1;
+    window.m_endColumn = 3;
+    const auto columns = lines(textable.toString(window));
+    ASSERT_EQ(columns.size(), 5);
+    const auto begin = full[0].find('+', 1);
+    const auto end = full[0].find('+', full[0].find('+', begin + 1) + 1);
+    for (size_t l = 0; l < columns.size(); ++l) {
+        EXPECT_EQ(columns[l], full[l].substr(begin, end - begin + 1));
+    }
+
+    // Clamped and empty windows.
+    window = Textable::Window();
+    EXPECT_EQ(textable.toString(window), textable.toString());
+    window.m_beginRow = 100;
+    EXPECT_EQ(textable.toString(window), "");
+    window.m_headerRows = 1;
+    EXPECT_EQ(lines(textable.toString(window)), (std::vector<std::string>{ full[0], full[1], full[2] }));
+
+    std::string buffer(4, '#');
+    EXPECT_EQ(textable.renderTo(&buffer[0], buffer.size(), window), textable.renderedSize(window));
+    EXPECT_EQ(buffer, "####");
+}
+
+TEST(General, RenderCache)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Left, "Name", "Value");
+    textable.setRow(1, Textable::Align::Right, u8"Երևան", 1.5);
+    const auto expected = textable.toString();
+
+    // Without the cache every snapshot is a new rendering.
+    EXPECT_NE(textable.snapshot(), textable.snapshot());
+
+    textable.setRenderCache(true);
+    const auto first = textable.snapshot();
+    EXPECT_EQ(*first, expected);
+    EXPECT_EQ(textable.snapshot(), first);
+    EXPECT_EQ(textable.toString(), expected);
+    std::ostringstream stream;
+    stream << textable;
+    EXPECT_EQ(stream.str(), expected);
+
+    // Every modification changes the generation and the snapshot.
+    auto generation = textable.generation();
+    textable.setCell(1, 1, Textable::Align::Right, 2.5);
+    EXPECT_NE(textable.generation(), generation);
+    generation = textable.generation();
+    textable.setRow(3, Textable::Align::Left, std::vector<int>{});
+    EXPECT_NE(textable.generation(), generation);
+    generation = textable.generation();
+    textable.setColumn(2, Textable::Align::Left, "x", "y");
+    EXPECT_NE(textable.generation(), generation);
+    generation = textable.generation();
+    textable.setColumnFormat(1, Textable::ColumnFormat());
+    EXPECT_NE(textable.generation(), generation);
+
+    const auto second = textable.snapshot();
+    EXPECT_NE(second, first);
+    EXPECT_EQ(*first, expected);
+
+    Textable uncached;
+    uncached.setRow(0, Textable::Align::Left, "Name", "Value", "x");
+    uncached.setRow(1, Textable::Align::Right, u8"Երևան", 2.5);
+    uncached.setCell(1, 2, Textable::Align::Left, "y");
+    uncached.setRow(3, Textable::Align::Left, std::vector<int>{});
+    EXPECT_EQ(*second, uncached.toString());
+    EXPECT_EQ(textable.toString(), uncached.toString());
+
+    // A copy doesn't share the cache.
+    auto copy = textable;
+    copy.setCell(0, 0, Textable::Align::Left, "Copy");
+    EXPECT_EQ(*textable.snapshot(), uncached.toString());
+    EXPECT_NE(*copy.snapshot(), uncached.toString());
+
+    // Readers keep their snapshots while the table is modified.
+    std::vector<std::thread> readers;
+    std::atomic<bool> ok{ true };
+    const auto view = textable.snapshot();
+    const auto text = *view;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&ok, &text, view]() {
+            for (int n = 0; n < 1000; ++n) {
+                if (*view != text) {
+                    ok = false;
+                }
+            }
+        });
+    }
+    for (int r = 0; r < 100; ++r) {
+        textable.setCell(r, 0, Textable::Align::Left, r);
+        textable.snapshot();
+    }
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_TRUE(ok);
+}
+
+TEST(General, RenderChanges)
+{
+    Textable textable;
+    for (int r = 0; r < 10; ++r) {
+        textable.setRow(r, Textable::Align::Right, r, "value", u8"Երևան");
+    }
+
+    std::string output;
+    auto ranges = textable.renderChanges(output);
+    EXPECT_EQ(output, textable.toString());
+    ASSERT_EQ(ranges.size(), 1);
+    EXPECT_EQ(ranges[0].m_offset, 0);
+    EXPECT_EQ(ranges[0].m_size, output.size());
+
+    // Nothing changed.
+    EXPECT_TRUE(textable.renderChanges(output).empty());
+    EXPECT_EQ(output, textable.toString());
+
+    // The same widths: only the changed rows are rewritten.
+    textable.setCell(7, 1, Textable::Align::Left, "other");
+    textable.setCell(2, 2, Textable::Align::Left, u8"Արմավ");
+    textable.setCell(7, 0, Textable::Align::Left, 1);
+    const auto before = output;
+    ranges = textable.renderChanges(output);
+    EXPECT_EQ(output, textable.toString());
+    ASSERT_EQ(ranges.size(), 2);
+    EXPECT_EQ(output.substr(ranges[0].m_offset, ranges[0].m_size), u8"|  2|  value|Արմավ  |\n");
+    EXPECT_EQ(output.substr(ranges[1].m_offset, ranges[1].m_size), u8"|1  |other  |  Երևան|\n");
+    for (size_t i = 0; i < output.size(); ++i) {
+        const auto inRange = (i >= ranges[0].m_offset && i < ranges[0].m_offset + ranges[0].m_size) ||
+                             (i >= ranges[1].m_offset && i < ranges[1].m_offset + ranges[1].m_size);
+        if (!inRange) {
+            ASSERT_EQ(output[i], before[i]);
+        }
+    }
+
+    // A wider cell changes the widths, so the table is rendered again.
+    textable.setCell(3, 1, Textable::Align::Left, "much wider value");
+    ranges = textable.renderChanges(output);
+    EXPECT_EQ(output, textable.toString());
+    ASSERT_EQ(ranges.size(), 1);
+    EXPECT_EQ(ranges[0].m_size, output.size());
+
+    // A different byte size of a row moves the following rows.
+    textable.setCell(4, 2, Textable::Align::Left, "Gyumri");
+    ranges = textable.renderChanges(output);
+    EXPECT_EQ(output, textable.toString());
+    ASSERT_EQ(ranges.size(), 1);
+
+    // A new row.
+    textable.setCell(10, 0, Textable::Align::Left, 10);
+    ranges = textable.renderChanges(output);
+    EXPECT_EQ(output, textable.toString());
+    ASSERT_EQ(ranges.size(), 1);
+}
+
+TEST(General, Splice)
+{
+    const std::string longText(64, 'x');
+
+    Textable first;
+    first.setRow(0, Textable::Align::Left, "a", longText, 1.5);
+    first.setColumnFormat(2, Textable::ColumnFormat{});
+
+    Textable second;
+    second.setRow(0, Textable::Align::Right, "much wider", longText);
+    second.setRow(1, Textable::Align::Center, 1, 2, 3, "four");
+
+    Textable expected;
+    expected.setRow(0, Textable::Align::Left, "a", longText, 1.5);
+    expected.setRow(1, Textable::Align::Right, "much wider", longText);
+    expected.setRow(2, Textable::Align::Center, 1, 2, 3, "four");
+
+    // The rows are moved: neither the cells nor their strings are allocated again.
+    first.reserve(3, 0);
+    const auto before = allocationCount.load();
+    first.splice(std::move(second));
+    EXPECT_LE(allocationCount - before, 2);
+
+    EXPECT_EQ(first.rowCount(), 3);
+    EXPECT_EQ(first.columnCount(), 4);
+    EXPECT_EQ(first.columnWidths(), expected.columnWidths());
+    EXPECT_EQ(first.toString(), expected.toString());
+    EXPECT_EQ(second.rowCount(), 0);
+    EXPECT_EQ(second.columnCount(), 0);
+
+    // The widths of the spliced rows are tracked as the own ones.
+    first.setCell(1, 0, Textable::Align::Right, "a");
+    expected.setCell(1, 0, Textable::Align::Right, "a");
+    EXPECT_EQ(first.columnWidths(), expected.columnWidths());
+    EXPECT_EQ(first.toString(), expected.toString());
+
+    Textable empty;
+    empty.splice(std::move(first));
+    EXPECT_EQ(empty.toString(), expected.toString());
+
+    // The width limits taken from the other table apply to the own rows too.
+    Textable::ColumnFormat limited;
+    limited.m_maxWidth = 5;
+
+    Textable unlimited;
+    unlimited.setRow(0, Textable::Align::Left, "x", "a very long cell text that exceeds");
+    Textable withLimit;
+    withLimit.setColumnFormat(1, limited);
+    withLimit.setRow(0, Textable::Align::Left, "y", "short");
+
+    Textable expectedLimited;
+    expectedLimited.setColumnFormat(1, limited);
+    expectedLimited.setRow(0, Textable::Align::Left, "x", "a very long cell text that exceeds");
+    expectedLimited.setRow(1, Textable::Align::Left, "y", "short");
+
+    unlimited.splice(std::move(withLimit));
+    EXPECT_EQ(unlimited.columnWidths(), expectedLimited.columnWidths());
+    EXPECT_EQ(unlimited.toString(), expectedLimited.toString());
+}
+
+TEST(General, ParallelRender)
+{
+    Textable textable;
+    for (int r = 0; r < 20000; ++r) {
+        textable.setRow(r, Textable::Align::Center, r, u8"Двадцать", r % 7 == 0 ? u8"日本語" : "text", r * 0.5);
+    }
+    textable.setCell(12345, 5, Textable::Align::Left, "Last");
+
+    const auto expected = textable.toString();
+    for (auto threads : { 0U, 2U, 3U, 7U, 64U }) {
+        EXPECT_EQ(textable.toString(threads), expected);
+
+        std::string buffer(expected.size(), ' ');
+        EXPECT_EQ(textable.renderTo(&buffer[0], buffer.size() - 1, threads), expected.size());
+        EXPECT_EQ(buffer, std::string(expected.size(), ' '));
+        EXPECT_EQ(textable.renderTo(&buffer[0], buffer.size(), threads), expected.size());
+        EXPECT_EQ(buffer, expected);
+    }
+
+    Textable empty;
+    EXPECT_EQ(empty.toString(4), "");
+}
+
+TEST(General, ColumnFormat)
+{
+    Textable textable;
+
+    Textable::ColumnFormat fixed;
+    fixed.m_notation = Textable::ColumnFormat::Notation::Fixed;
+    fixed.m_precision = 2;
+    fixed.m_thousandsSeparator = ',';
+    textable.setColumnFormat(0, fixed);
+
+    Textable::ColumnFormat scientific;
+    scientific.m_notation = Textable::ColumnFormat::Notation::Scientific;
+    scientific.m_precision = 1;
+    textable.setColumnFormat(1, scientific);
+
+    Textable::ColumnFormat decimal;
+    decimal.m_decimalAlign = true;
+    decimal.m_thousandsSeparator = '\'';
+    textable.setColumnFormat(2, decimal);
+
+    Textable::ColumnFormat wide;
+    wide.m_width = 6;
+    textable.setColumnFormat(3, wide);
+
+    ASSERT_NE(textable.columnFormat(2), nullptr);
+    EXPECT_TRUE(textable.columnFormat(2)->m_decimalAlign);
+    EXPECT_EQ(textable.columnFormat(4), nullptr);
+
+    textable.setRow(0, Textable::Align::Left, "Amount", "Sci", "Value", "Id");
+    textable.setRow(1, Textable::Align::Right, 1234567.891, 12345, 1.5, 1);
+    textable.setRow(2, Textable::Align::Right, -0.5, 0.25, 1234567, 2);
+    textable.setRow(3, Textable::Align::Right, 42, -1.0, -3.125, 3);
+    textable.setCell(4, 2, Textable::Align::Center, "n/a");
+
+    EXPECT_EQ(textable.columnWidths(), (std::vector<size_t>{ 12, 8, 13, 6 }));
+
+    const std::string expected("+--------------+----------+---------------+--------+\n"
+                               "|Amount        |Sci       |Value          |Id      |\n"
+                               "+--------------+----------+---------------+--------+\n"
+                               "|  1,234,567.89|   1.2e+04|          1.5  |       1|\n"
+                               "+--------------+----------+---------------+--------+\n"
+                               "|         -0.50|   2.5e-01|  1'234'567    |       2|\n"
+                               "+--------------+----------+---------------+--------+\n"
+                               "|         42.00|  -1.0e+00|         -3.125|       3|\n"
+                               "+--------------+----------+---------------+--------+\n"
+                               "|              |          |      n/a      |        |\n"
+                               "+--------------+----------+---------------+--------+\n");
+    EXPECT_EQ(textable.toString(), expected);
+    EXPECT_EQ(textable.renderedSize(), expected.size());
+}
+
+TEST(General, MaxWidth)
+{
+    Textable textable;
+    Textable::ColumnFormat wrap;
+    wrap.m_maxWidth = 10;
+    wrap.m_overflow = Textable::ColumnFormat::Overflow::Wrap;
+    textable.setColumnFormat(1, wrap);
+    Textable::ColumnFormat truncate;
+    truncate.m_maxWidth = 6;
+    textable.setColumnFormat(2, truncate);
+
+    textable.setRow(0, Textable::Align::Left, "Id", "Message", "Code");
+    textable.setRow(1, Textable::Align::Left, 1, "the quick brown fox jumps", "ABCDEFGHIJ");
+    textable.setRow(2, Textable::Align::Left, 2, "ok", u8"日本語日本");
+
+    EXPECT_EQ(textable.columnWidths(), (std::vector<size_t>{ 2, 10, 6 }));
+    EXPECT_EQ(textable.cellData(1, 1), "the quick brown fox jumps");
+
+    const std::string expected(u8"+----+------------+--------+\n"
+                               u8"|Id  |Message     |Code    |\n"
+                               u8"+----+------------+--------+\n"
+                               u8"|1   |the quick   |ABCDE…  |\n"
+                               u8"|    |brown fox   |        |\n"
+                               u8"|    |jumps       |        |\n"
+                               u8"+----+------------+--------+\n"
+                               u8"|2   |ok          |日本…   |\n"
+                               u8"+----+------------+--------+\n");
+    EXPECT_EQ(textable.toString(), expected);
+    EXPECT_EQ(textable.renderedSize(), expected.size());
+    EXPECT_EQ(textable.toString(3), expected);
+    EXPECT_EQ(textable.toString(Textable::Window()), expected);
+    std::ostringstream stream;
+    stream << textable;
+    EXPECT_EQ(stream.str(), expected);
+    EXPECT_EQ(TextableView(textable).toString(), expected);
+
+    std::string chunks;
+    ChunkedRenderer renderer(textable);
+    char buffer[7];
+    for (size_t size; (size = renderer.next(buffer, sizeof(buffer))) > 0;) {
+        chunks.append(buffer, size);
+    }
+    EXPECT_EQ(chunks, expected);
+
+    // The copies and the spliced tables keep the lines.
+    auto copy = textable;
+    EXPECT_EQ(copy.toString(), expected);
+    Textable spliced;
+    spliced.splice(std::move(copy));
+    EXPECT_EQ(spliced.toString(), expected);
+
+    // Wrapped tables are not saved, truncated ones are saved as shown.
+    std::ostringstream binary;
+    EXPECT_FALSE(MappedTextable::save(textable, binary));
+    textable.setColumnFormat(1, truncate);
+    std::ostringstream truncated;
+    truncated << textable;
+    EXPECT_NE(truncated.str().find(u8"|the q…  |"), std::string::npos);
+    std::ostringstream saved;
+    ASSERT_TRUE(MappedTextable::save(textable, saved));
+    std::vector<uint64_t> data(saved.str().size() / 8 + 1);
+    std::memcpy(data.data(), saved.str().data(), saved.str().size());
+    MappedTextable mapped;
+    ASSERT_TRUE(mapped.load(reinterpret_cast<const char *>(data.data()), saved.str().size()));
+    EXPECT_EQ(mapped.toString(), truncated.str());
+
+    // Hard breaks, long words and the overwritten cells.
+    Textable narrow;
+    wrap.m_maxWidth = 4;
+    narrow.setColumnFormat(0, wrap);
+    narrow.setCell(0, 0, Textable::Align::Left, "abcdefghij\r\nxy");
+    EXPECT_EQ(narrow.toString(), "+------+\n|abcd  |\n|efgh  |\n|ij    |\n|xy    |\n+------+\n");
+    narrow.setCell(0, 0, Textable::Align::Left, "ok");
+    EXPECT_EQ(narrow.toString(), "+----+\n|ok  |\n+----+\n");
+}
+
+/// Fills the \p table with values of different types and alignments.
+template<typename Table>
+void fillMixed(Table &table)
+{
+    table.setRow(0, Textable::Align::Left, "Name", "Count", u8"Größe");
+    table.setRow(1, Textable::Align::Right, std::vector<std::string>{ u8"Երևան", "42", "1.5" });
+    table.setColumn(3, Textable::Align::Center, std::vector<int>{ 1, 22, 333 });
+    table.setCell(4, 1, Textable::Align::Left, u8"日本語");
+    table.setCell(2, 0, Textable::Align::Center, 3.25);
+    table.setCell(3, 4, Textable::Align::Right, true);
+}
+
+TEST(ChunkedRenderer, SameAsToString)
+{
+    Textable textable;
+    fillMixed(textable);
+    textable.appendRow(Textable::Align::Center, std::string(300, 'x'), u8"Ծաղկաձոր");
+    const auto expected = textable.toString();
+
+    for (size_t capacity : { 1, 7, 64, 1000, 100000 }) {
+        ChunkedRenderer renderer(textable);
+        std::vector<char> buffer(capacity);
+        std::string output;
+        while (!renderer.done()) {
+            const auto size = renderer.next(buffer.data(), buffer.size());
+            ASSERT_GT(size, 0u);
+            ASSERT_TRUE(size == capacity || renderer.done());
+            output.append(buffer.data(), size);
+        }
+        EXPECT_EQ(renderer.next(buffer.data(), buffer.size()), 0u);
+        EXPECT_EQ(output, expected) << "capacity " << capacity;
+        EXPECT_EQ(renderer.renderedSize(), expected.size());
+    }
+
+    // Restart after a part of a line.
+    ChunkedRenderer renderer(textable);
+    char buffer[5];
+    renderer.next(buffer, sizeof(buffer));
+    renderer.restart();
+    std::string output;
+    for (size_t size; (size = renderer.next(buffer, sizeof(buffer))) > 0;) {
+        output.append(buffer, size);
+    }
+    EXPECT_EQ(output, expected);
+
+    Textable empty;
+    ChunkedRenderer emptyRenderer(empty);
+    EXPECT_TRUE(emptyRenderer.done());
+    EXPECT_EQ(emptyRenderer.next(buffer, sizeof(buffer)), 0u);
+}
+
+TEST(ColumnarTextable, SameAsTextable)
+{
+    ColumnarTextable columnar;
+    Textable textable;
+    EXPECT_EQ(columnar.toString(), "");
+    EXPECT_EQ(columnar.renderedSize(), 0);
+
+    fillMixed(columnar);
+    fillMixed(textable);
+    EXPECT_EQ(columnar.rowCount(), textable.rowCount());
+    EXPECT_EQ(columnar.columnCount(), textable.columnCount());
+    EXPECT_EQ(columnar.cellData(1, 0), u8"Երևան");
+    EXPECT_EQ(columnar.cellData(2, 3), "333");
+    EXPECT_EQ(columnar.cellData(7, 7), "");
+    EXPECT_EQ(columnar.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(columnar.renderedSize(), textable.renderedSize());
+    EXPECT_EQ(columnar.toString(), textable.toString());
+
+    std::ostringstream stream;
+    stream << columnar;
+    EXPECT_EQ(stream.str(), textable.toString());
+}
+
+TEST(ColumnarTextable, Overwrite)
+{
+    ColumnarTextable columnar;
+    Textable textable;
+    for (int r = 0; r < 10000; ++r) {
+        columnar.setRow(r, Textable::Align::Center, r, u8"Двадцать", r % 7 == 0 ? u8"日本語" : "text");
+        textable.setRow(r, Textable::Align::Center, r, u8"Двадцать", r % 7 == 0 ? u8"日本語" : "text");
+    }
+
+    // Overwrite the widest cells many times, so that the arena is compacted.
+    const auto memoryUsage = columnar.memoryUsage();
+    for (int i = 0; i < 5; ++i) {
+        for (int r = 0; r < 10000; ++r) {
+            columnar.setCell(r, 1, Textable::Align::Left, "short");
+            textable.setCell(r, 1, Textable::Align::Left, "short");
+        }
+    }
+    EXPECT_LE(columnar.memoryUsage(), memoryUsage);
+    EXPECT_EQ(columnar.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(columnar.cellData(9999, 1), "short");
+    EXPECT_EQ(columnar.toString(), textable.toString());
+    EXPECT_EQ(columnar.toString(3), textable.toString());
+
+    // The rows set from containers are replaced as a whole, even by shorter ones.
+    const std::vector<std::string> longRow{ "a", "b", "c", "the widest cell", "" };
+    const std::vector<std::string> shortRow{ "x" };
+    for (auto row : { 5, 9999 }) {
+        columnar.setRow(row, Textable::Align::Right, longRow);
+        textable.setRow(row, Textable::Align::Right, longRow);
+    }
+    EXPECT_EQ(columnar.columnCount(), 5);
+    columnar.setRow(5, Textable::Align::Left, shortRow);
+    textable.setRow(5, Textable::Align::Left, shortRow);
+    EXPECT_EQ(columnar.columnCount(), textable.columnCount());
+    EXPECT_EQ(columnar.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(columnar.toString(), textable.toString());
+
+    columnar.setRow(9999, Textable::Align::Left, shortRow);
+    textable.setRow(9999, Textable::Align::Left, shortRow);
+    columnar.setRow(10005, Textable::Align::Left, std::vector<std::string>{});
+    textable.setRow(10005, Textable::Align::Left, std::vector<std::string>{});
+    EXPECT_EQ(columnar.rowCount(), textable.rowCount());
+    EXPECT_EQ(columnar.columnCount(), textable.columnCount());
+    EXPECT_EQ(columnar.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(columnar.cellData(9999, 2), "");
+    EXPECT_EQ(columnar.toString(), textable.toString());
+}
+
+TEST(CsvReader, Format)
+{
+    const std::string csv = "name,value,comment\r\n"
+                            "plain,1,\n"
+                            "\"quoted, with delimiter\",\"2\",\"line\nbreak\"\r\n"
+                            "\"\"\"escaped\"\" quotes\",3,x\"y\"z\n"
+                            "\n"
+                            u8"Երևան,4,last";
+    Textable textable;
+    CsvReader().parse(csv.data(), csv.size(), textable);
+
+    ASSERT_EQ(textable.rowCount(), 6);
+    EXPECT_EQ(textable.columnCount(), 3);
+    EXPECT_EQ(textable.cellData(0, 2), "comment");
+    EXPECT_EQ(textable.cellData(1, 2), "");
+    EXPECT_EQ(textable.cellData(2, 0), "quoted, with delimiter");
+    EXPECT_EQ(textable.cellData(2, 1), "2");
+    EXPECT_EQ(textable.cellData(2, 2), "line\nbreak");
+    EXPECT_EQ(textable.cellData(3, 0), "\"escaped\" quotes");
+    EXPECT_EQ(textable.cellData(3, 2), "xyz");
+    EXPECT_EQ(textable.cellData(4, 0), "");
+    EXPECT_EQ(textable.cellData(5, 0), u8"Երևան");
+    EXPECT_EQ(textable.cellData(5, 2), "last");
+
+    Textable expected;
+    expected.setRow(0, Textable::Align::Left, "name", "value", "comment");
+    expected.setRow(1, Textable::Align::Left, "plain", "1", "");
+    expected.setRow(2, Textable::Align::Left, "quoted, with delimiter", "2", "line\nbreak");
+    expected.setRow(3, Textable::Align::Left, "\"escaped\" quotes", "3", "xyz");
+    expected.setRow(4, Textable::Align::Left, "");
+    expected.setRow(5, Textable::Align::Left, u8"Երևան", "4", "last");
+    EXPECT_EQ(textable.toString(), expected.toString());
+
+    // TSV, appended to the existing rows.
+    CsvReader::Options options;
+    options.m_delimiter = '\t';
+    const std::string tsv = "a,b\tc\n";
+    CsvReader(options).parse(tsv.data(), tsv.size(), textable);
+    ASSERT_EQ(textable.rowCount(), 7);
+    EXPECT_EQ(textable.cellData(6, 0), "a,b");
+    EXPECT_EQ(textable.cellData(6, 1), "c");
+}
+
+TEST(CsvReader, Chunks)
+{
+    // Quoted line breaks and delimiters around the chunk boundaries.
+    std::string csv;
+    std::srand(7);
+    for (int r = 0; r < 2000; ++r) {
+        const auto fields = 1 + std::rand() % 5;
+        for (int f = 0; f < fields; ++f) {
+            if (f > 0) {
+                csv += ',';
+            }
+            switch (std::rand() % 4) {
+            case 0:
+                csv += std::to_string(std::rand());
+                break;
+            case 1:
+                csv += "\"multi\nline, \"\"field\"\"\n\"";
+                break;
+            case 2:
+                csv += u8"\"Գյումրի\"";
+                break;
+            default:
+                break;
+            }
+        }
+        csv += r % 3 == 0 ? "\r\n" : "\n";
+    }
+
+    CsvReader::Options options;
+    options.m_threadCount = 1;
+    Textable serial;
+    CsvReader(options).parse(csv.data(), csv.size(), serial);
+    EXPECT_EQ(serial.rowCount(), 2000);
+
+    options.m_threadCount = 7;
+    options.m_chunkSize = 64;
+    Textable parallel;
+    CsvReader(options).parse(csv.data(), csv.size(), parallel);
+    EXPECT_EQ(parallel.rowCount(), serial.rowCount());
+    EXPECT_EQ(parallel.columnWidths(), serial.columnWidths());
+    EXPECT_EQ(parallel.toString(), serial.toString());
+}
+
+TEST(CsvReader, File)
+{
+    const std::string path = "csvreader_test.csv";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "first,second\n1,2\n";
+    }
+
+    Textable textable;
+    EXPECT_TRUE(CsvReader().read(path, textable));
+    EXPECT_EQ(textable.rowCount(), 2);
+    EXPECT_EQ(textable.cellData(1, 1), "2");
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(CsvReader().read("no/such/file.csv", textable));
+    EXPECT_EQ(textable.rowCount(), 2);
+}
+
+TEST(LazyTextable, SameAsTextable)
+{
+    LazyTextable lazy;
+    Textable textable;
+    EXPECT_EQ(lazy.toString(), "");
+
+    fillMixed(lazy);
+    fillMixed(textable);
+    const std::vector<double> values{ 0.1, -2.5e-10, 1e300, 7.0 };
+    lazy.setRow(5, Textable::Align::Right, -7LL, 18446744073709551615ULL, 2.5f, 'c', false, 1.25L);
+    textable.setRow(5, Textable::Align::Right, -7LL, 18446744073709551615ULL, 2.5f, 'c', false, 1.25L);
+    lazy.setColumn(6, Textable::Align::Left, values);
+    textable.setColumn(6, Textable::Align::Left, values);
+
+    // Only the strings have been converted to text so far.
+    EXPECT_EQ(lazy.pendingCount(), 14);
+    EXPECT_EQ(lazy.rowCount(), textable.rowCount());
+    EXPECT_EQ(lazy.columnCount(), textable.columnCount());
+    EXPECT_EQ(lazy.cellData(2, 3), "333");
+    EXPECT_EQ(lazy.pendingCount(), 13);
+    EXPECT_EQ(lazy.cellData(7, 7), "");
+
+    EXPECT_EQ(lazy.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(lazy.pendingCount(), 0);
+    EXPECT_EQ(lazy.renderedSize(), textable.renderedSize());
+    EXPECT_EQ(lazy.toString(), textable.toString());
+    EXPECT_EQ(lazy.toString(4), textable.toString());
+
+    // Overwritten cells are converted again.
+    lazy.setCell(5, 1, Textable::Align::Left, 1);
+    textable.setCell(5, 1, Textable::Align::Left, 1);
+    EXPECT_EQ(lazy.pendingCount(), 1);
+    EXPECT_EQ(lazy.columnWidths(), textable.columnWidths());
+
+    std::ostringstream stream;
+    stream << lazy;
+    EXPECT_EQ(stream.str(), textable.toString());
+
+    // Numbers are stored without allocations.
+    LazyTextable numbers;
+    numbers.setRow(99, Textable::Align::Right, 0, 0.0);
+    const auto before = allocationCount.load();
+    for (int r = 0; r < 100; ++r) {
+        numbers.setRow(r, Textable::Align::Right, r * 1000003LL, r * 0.001);
+    }
+    EXPECT_EQ(allocationCount - before, 0);
+}
+
+TEST(LazyTextable, Deferred)
+{
+    struct Point
+    {
+        int m_x;
+        int m_y;
+    };
+
+    int calls = 0;
+    LazyTextable lazy;
+    const Point point{ 3, 4 };
+    lazy.setDeferredCell(0, 0, Textable::Align::Left, [point, &calls]() {
+        ++calls;
+        return "(" + std::to_string(point.m_x) + ", " + std::to_string(point.m_y) + ")";
+    });
+    lazy.setDeferredCell(1, 0, Textable::Align::Left, [&calls]() {
+        ++calls;
+        return std::string(u8"日本");
+    });
+    lazy.setDeferredCell(2, 0, Textable::Align::Left, nullptr);
+    EXPECT_EQ(calls, 0);
+
+    EXPECT_EQ(lazy.cellData(0, 0), "(3, 4)");
+    EXPECT_EQ(lazy.cellData(0, 0), "(3, 4)");
+    EXPECT_EQ(calls, 1);
+
+    Textable textable;
+    textable.setCell(0, 0, Textable::Align::Left, "(3, 4)");
+    textable.setCell(1, 0, Textable::Align::Left, u8"日本");
+    textable.setCell(2, 0, Textable::Align::Left, "");
+    EXPECT_EQ(lazy.toString(), textable.toString());
+    EXPECT_EQ(lazy.toString(), textable.toString());
+    EXPECT_EQ(calls, 2);
+}
+
+/// Returns the saved \p table in 8 byte aligned memory.
+std::vector<uint64_t> saveTable(const Textable &table, size_t &size)
+{
+    std::ostringstream stream;
+    EXPECT_TRUE(MappedTextable::save(table, stream));
+    const auto data = stream.str();
+    std::vector<uint64_t> buffer(data.size() / 8 + 1);
+    std::memcpy(buffer.data(), data.data(), data.size());
+    size = data.size();
+    return buffer;
+}
+
+TEST(MappedTextable, RoundTrip)
+{
+    Textable textable;
+    Textable::ColumnFormat decimal;
+    decimal.m_decimalAlign = true;
+    textable.setColumnFormat(1, decimal);
+    Textable::ColumnFormat wide;
+    wide.m_width = 12;
+    textable.setColumnFormat(5, wide);
+    fillMixed(textable);
+    textable.setCell(5, 5, Textable::Align::Right, "-1.25e3");
+    const auto expected = textable.toString();
+
+    size_t size = 0;
+    const auto data = saveTable(textable, size);
+    MappedTextable mapped;
+    ASSERT_TRUE(mapped.load(reinterpret_cast<const char *>(data.data()), size));
+
+    EXPECT_EQ(mapped.rowCount(), textable.rowCount());
+    EXPECT_EQ(mapped.columnCount(), textable.columnCount());
+    EXPECT_EQ(mapped.columnWidths(), textable.columnWidths());
+    for (Textable::RowNumber r = 0; r <= textable.rowCount(); ++r) {
+        for (Textable::ColumnNumber c = 0; c <= textable.columnCount(); ++c) {
+            EXPECT_EQ(mapped.cellData(r, c), textable.cellData(r, c));
+        }
+    }
+    EXPECT_EQ(mapped.toString(), expected);
+    EXPECT_EQ(mapped.renderedSize(), expected.size());
+    std::ostringstream stream;
+    stream << mapped;
+    EXPECT_EQ(stream.str(), expected);
+    EXPECT_EQ(mapped.toTextable().toString(), expected);
+
+    Textable empty;
+    const auto emptyData = saveTable(empty, size);
+    ASSERT_TRUE(mapped.load(reinterpret_cast<const char *>(emptyData.data()), size));
+    EXPECT_EQ(mapped.rowCount(), 0);
+    EXPECT_EQ(mapped.toString(), "");
+}
+
+TEST(MappedTextable, File)
+{
+    Textable textable;
+    fillMixed(textable);
+    const std::string path("textable_test.tbl");
+    ASSERT_TRUE(MappedTextable::save(textable, path));
+
+    MappedTextable mapped;
+    ASSERT_TRUE(mapped.open(path));
+    EXPECT_EQ(mapped.toString(), textable.toString());
+
+    // The moved table keeps the mapping.
+    MappedTextable moved(std::move(mapped));
+    EXPECT_EQ(moved.toString(), textable.toString());
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(mapped.open("textable_missing.tbl"));
+    EXPECT_EQ(mapped.rowCount(), 0);
+}
+
+TEST(MappedTextable, Invalid)
+{
+    Textable textable;
+    fillMixed(textable);
+    size_t size = 0;
+    auto data = saveTable(textable, size);
+    auto bytes = reinterpret_cast<char *>(data.data());
+
+    MappedTextable mapped;
+    EXPECT_FALSE(mapped.load(bytes, size - 1));
+    EXPECT_FALSE(mapped.load(bytes + 8, size - 8));
+
+    // The first cell refers past the texts.
+    const auto layoutSize = data[4];
+    const auto rowCount = data[2];
+    auto &offset = data[7 + layoutSize + rowCount + 1];
+    offset = size;
+    EXPECT_FALSE(mapped.load(bytes, size));
+    offset = 0;
+    EXPECT_TRUE(mapped.load(bytes, size));
+
+    bytes[0] = 'X';
+    EXPECT_FALSE(mapped.load(bytes, size));
+    EXPECT_EQ(mapped.toString(), "");
+}
+
+TEST(SparseTextable, SameAsTextable)
+{
+    SparseTextable sparse;
+    Textable textable;
+    EXPECT_EQ(sparse.toString(), "");
+
+    sparse.setCell(4, 1, Textable::Align::Center, "A Single Value");
+    textable.setCell(4, 1, Textable::Align::Center, "A Single Value");
+    EXPECT_EQ(sparse.rowCount(), 5);
+    EXPECT_EQ(sparse.columnCount(), 2);
+    EXPECT_EQ(sparse.cellCount(), 1);
+    EXPECT_EQ(sparse.toString(), textable.toString());
+
+    fillMixed(sparse);
+    fillMixed(textable);
+    sparse.setCell(30, 9, Textable::Align::Right, u8"Երևան");
+    textable.setCell(30, 9, Textable::Align::Right, u8"Երևան");
+    EXPECT_EQ(sparse.cellData(30, 9), u8"Երևան");
+    EXPECT_EQ(sparse.cellData(29, 9), "");
+    EXPECT_EQ(sparse.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(sparse.renderedSize(), textable.renderedSize());
+    EXPECT_EQ(sparse.toString(), textable.toString());
+
+    // Replacing the longest and the widest rows shrinks the table.
+    sparse.setRow(30, Textable::Align::Left, std::vector<std::string>{ "x" });
+    textable.setRow(30, Textable::Align::Left, std::vector<std::string>{ "x" });
+    sparse.setRow(1, Textable::Align::Left, std::vector<int>{});
+    textable.setRow(1, Textable::Align::Left, std::vector<int>{});
+    EXPECT_EQ(sparse.columnCount(), textable.columnCount());
+    EXPECT_EQ(sparse.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(sparse.toString(), textable.toString());
+
+    std::ostringstream stream;
+    stream << sparse;
+    EXPECT_EQ(stream.str(), textable.toString());
+}
+
+TEST(SparseTextable, FarApartCells)
+{
+    SparseTextable sparse;
+    sparse.setCell(0, 0, Textable::Align::Left, "first");
+    const auto before = allocationCount.load();
+    sparse.setCell(1000000, 50, Textable::Align::Right, "last");
+
+    // The row, its cells, its size and the column widths, but nothing for the empty rows.
+    EXPECT_LE(allocationCount - before, 4);
+
+    EXPECT_EQ(sparse.rowCount(), 1000001);
+    EXPECT_EQ(sparse.columnCount(), 51);
+    EXPECT_EQ(sparse.cellCount(), 2);
+
+    const auto output = sparse.toString();
+    EXPECT_EQ(output.size(), sparse.renderedSize());
+    EXPECT_EQ(output.compare(0, 10, "+-------+-"), 0);
+    const auto lineSize = output.find('\n') + 1;
+    const auto lastRow = output.substr(output.size() - 2 * lineSize, lineSize);
+    const std::string suffix = "|  |  last|\n";
+    EXPECT_EQ(lastRow.substr(lastRow.size() - suffix.size()), suffix);
+    EXPECT_EQ(lastRow.substr(0, 10), "|       | ");
+}
+
+TEST(TableWriter, SameAsTextable)
+{
+    Textable textable;
+    std::ostringstream stream;
+    {
+        TableWriter writer(stream);
+        for (int r = 0; r < 10; ++r) {
+            textable.setRow(r, Textable::Align::Left, r, u8"Fünf", r * 1.5);
+            writer.addRow(Textable::Align::Left, r, u8"Fünf", r * 1.5);
+        }
+        textable.setRow(10, Textable::Align::Right, std::vector<std::string>{ "a", "b" });
+        writer.addRow(Textable::Align::Right, std::vector<std::string>{ "a", "b" });
+        EXPECT_EQ(writer.rowCount(), 11);
+        EXPECT_EQ(stream.str(), "");
+    }
+    EXPECT_EQ(stream.str(), textable.toString());
+}
+
+TEST(TableWriter, FirstBatch)
+{
+    std::ostringstream stream;
+    TableWriter::Options options;
+    options.m_batchSize = 2;
+    options.m_ellipsis = "~";
+
+    TableWriter writer(stream, options);
+    writer.addRow(Textable::Align::Left, "abc", 1);
+    EXPECT_EQ(stream.str(), "");
+    writer.addRow(Textable::Align::Left, "a", 12);
+    EXPECT_EQ(stream.str(), "+-----+----+\n"
+                            "|abc  |1   |\n"
+                            "+-----+----+\n"
+                            "|a    |12  |\n"
+                            "+-----+----+\n");
+    EXPECT_EQ(writer.columnWidths(), (std::vector<size_t>{ 3, 2 }));
+
+    // The widths are fixed now.
+    writer.addRow(Textable::Align::Left, u8"Двадцать", 123, "dropped");
+    EXPECT_EQ(stream.str(), u8"+-----+----+\n"
+                            u8"|abc  |1   |\n"
+                            u8"+-----+----+\n"
+                            u8"|a    |12  |\n"
+                            u8"+-----+----+\n"
+                            u8"|Дв~  |1~  |\n"
+                            u8"+-----+----+\n");
+}
+
+TEST(TableWriter, Window)
+{
+    std::ostringstream stream;
+    TableWriter::Options options;
+    options.m_mode = TableWriter::Mode::Window;
+    options.m_batchSize = 1;
+    options.m_widths = { 2 };
+
+    TableWriter writer(stream, options);
+    writer.addRow(Textable::Align::Center, "a");
+    writer.addRow(Textable::Align::Center, "abcd", 1);
+    EXPECT_EQ(stream.str(), "+----+\n"
+                            "| a  |\n"
+                            "+----+\n"
+                            "| abcd | 1 |\n"
+                            "+------+---+\n");
+}
+
+TEST(TableWriter, Fixed)
+{
+    std::ostringstream stream;
+    TableWriter::Options options;
+    options.m_mode = TableWriter::Mode::Fixed;
+    options.m_widths = { 4, 1 };
+
+    TableWriter writer(stream, options);
+    writer.addRow(Textable::Align::Right, "Long text", "", "dropped");
+    EXPECT_EQ(stream.str(), u8"+------+---+\n"
+                            u8"|  Lon…|   |\n"
+                            u8"+------+---+\n");
+}
+
+#if !defined(_WIN32)
+TEST(TableWriter, InterruptedWrite)
 {
-    // This is required to properly handle the multi-byte string sizes.
-    std::setlocale(LC_ALL, "en_US.utf8");
+    int pipe[2];
+    ASSERT_EQ(::pipe(pipe), 0);
+
+    // Fill the pipe up, so that the writer blocks before writing anything.
+    ::fcntl(pipe[1], F_SETFL, O_NONBLOCK);
+    size_t filled = 0;
+    for (size_t chunk : { 4096, 1 }) {
+        const std::string filler(chunk, 'f');
+        ssize_t written = 0;
+        while ((written = ::write(pipe[1], filler.data(), filler.size())) > 0) {
+            filled += static_cast<size_t>(written);
+        }
+    }
+    ::fcntl(pipe[1], F_SETFL, 0);
+
+    // The handler installed without SA_RESTART makes the blocked write fail with EINTR.
+    struct sigaction action = {};
+    action.sa_handler = [](int) {};
+    struct sigaction oldAction = {};
+    ::sigaction(SIGUSR1, &action, &oldAction);
+
+    const auto writerThread = ::pthread_self();
+    std::string output;
+    std::thread reader([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ::pthread_kill(writerThread, SIGUSR1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        char buffer[4096];
+        ssize_t size = 0;
+        while ((size = ::read(pipe[0], buffer, sizeof(buffer))) > 0) {
+            output.append(buffer, static_cast<size_t>(size));
+        }
+    });
+
+    Textable textable;
+    {
+        TableWriter writer(pipe[1]);
+        for (int r = 0; r < 10; ++r) {
+            textable.setRow(r, Textable::Align::Left, r, u8"Fünf", r * 1.5);
+            writer.addRow(Textable::Align::Left, r, u8"Fünf", r * 1.5);
+        }
+        writer.flush();
+        EXPECT_TRUE(writer.good());
+    }
+    ::close(pipe[1]);
+    reader.join();
+    ::close(pipe[0]);
+    ::sigaction(SIGUSR1, &oldAction, nullptr);
 
+    ASSERT_GE(output.size(), filled);
+    EXPECT_EQ(output.substr(filled), textable.toString());
+}
+#endif
+
+TEST(TextableBuilder, ConcurrentProducers)
+{
+    static const int threadCount = 8;
+    static const int rowCount = 2000;
+
+    TextableBuilder builder;
+    std::atomic<bool> start{ false };
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threadCount; ++t) {
+        producers.emplace_back([&builder, &start, t]() {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < rowCount; ++i) {
+                builder.appendRow(Textable::Align::Left, t, i, std::string(static_cast<size_t>(i % 37), 'x'));
+            }
+        });
+    }
+    start = true;
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(builder.shardCount(), threadCount);
+
+    const auto textable = builder.build();
+    EXPECT_EQ(builder.shardCount(), 0);
+    ASSERT_EQ(textable.rowCount(), threadCount * rowCount);
+    EXPECT_EQ(textable.columnCount(), 3);
+
+    // The rows of each thread are contiguous and keep their order.
+    Textable expected;
+    for (Textable::RowNumber r = 0; r < textable.rowCount(); ++r) {
+        EXPECT_EQ(textable.cellData(r, 1), std::to_string(r % rowCount));
+        EXPECT_EQ(textable.cellData(r, 0), textable.cellData(r - r % rowCount, 0));
+        expected.appendRow(Textable::Align::Left, textable.cellData(r, 0), textable.cellData(r, 1),
+                           textable.cellData(r, 2));
+    }
+    EXPECT_EQ(textable.toString(), expected.toString());
+
+    // The builder can be populated again.
+    builder.appendRow(Textable::Align::Left, "again");
+    EXPECT_EQ(builder.build().cellData(0, 0), "again");
+}
+
+TEST(TextableView, SortFilter)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Left, "City", "Population", "Code");
+    textable.setRow(1, Textable::Align::Left, u8"Երևան", "1,092,800", "AM");
+    textable.setRow(2, Textable::Align::Left, "Gyumri", "121976", "AM");
+    textable.setRow(3, Textable::Align::Left, "Tbilisi", "n/a");
+    textable.setRow(4, Textable::Align::Left, "Batumi", "-", "GE");
+    textable.setRow(5, Textable::Align::Left, "Vanadzor", "9.5e4", "AM");
+
+    TextableView view(textable, 1);
+    EXPECT_EQ(view.toString(), textable.toString());
+
+    // Numbers by their values, then texts.
+    view.sort(1);
+    std::vector<Textable::RowNumber> rows;
+    for (Textable::RowNumber r = 0; r < view.rowCount(); ++r) {
+        rows.push_back(view.tableRow(r));
+    }
+    EXPECT_EQ(rows, (std::vector<Textable::RowNumber>{ 0, 5, 2, 1, 4, 3 }));
+
+    // Stable: the equal codes keep the population order, the missing code is the smallest.
+    view.sort(2, TextableView::Order::Descending);
+    rows.clear();
+    for (Textable::RowNumber r = 0; r < view.rowCount(); ++r) {
+        rows.push_back(view.tableRow(r));
+    }
+    EXPECT_EQ(rows, (std::vector<Textable::RowNumber>{ 0, 4, 5, 2, 1, 3 }));
+
+    // The widths are the ones of the visible rows.
+    view.filter([](const Textable::Row &row) { return row.size() > 2 && row[2].m_data == "AM"; });
+    EXPECT_EQ(view.rowCount(), 4);
+    EXPECT_EQ(view.columnWidths(), (std::vector<size_t>{ 8, 10, 4 }));
+
+    Textable expected;
+    for (Textable::RowNumber r = 0; r < view.rowCount(); ++r) {
+        for (Textable::ColumnNumber c = 0; c < 3; ++c) {
+            expected.setCell(r, c, Textable::Align::Left, textable.cellData(view.tableRow(r), c));
+        }
+    }
+    EXPECT_EQ(view.toString(), expected.toString());
+    EXPECT_EQ(view.renderedSize(), expected.renderedSize());
+
+    std::ostringstream stream;
+    stream << view;
+    EXPECT_EQ(stream.str(), expected.toString());
+
+    view.reset();
+    EXPECT_EQ(view.toString(), textable.toString());
+}
+
+TEST(TextableView, ParallelSort)
+{
+    Textable textable;
+    for (int i = 0; i < 50000; ++i) {
+        textable.appendRow(Textable::Align::Right, (i * 7919) % 1000, i);
+    }
+
+    TextableView single(textable);
+    single.sort(0);
+    TextableView parallel(textable);
+    parallel.sort(0, TextableView::Order::Ascending, 4);
+
+    ASSERT_EQ(parallel.rowCount(), textable.rowCount());
+    for (Textable::RowNumber r = 0; r < parallel.rowCount(); ++r) {
+        ASSERT_EQ(parallel.tableRow(r), single.tableRow(r));
+    }
+    for (Textable::RowNumber r = 1; r < parallel.rowCount(); ++r) {
+        const auto previous = std::stoi(textable.cellData(parallel.tableRow(r - 1), 0));
+        const auto current = std::stoi(textable.cellData(parallel.tableRow(r), 0));
+        ASSERT_TRUE(previous < current || (previous == current &&
+                                           parallel.tableRow(r - 1) < parallel.tableRow(r)));
+    }
+
+    // Sorting and filtering don't copy the cells.
+    const auto before = allocationCount.load();
+    TextableView view(textable);
+    view.filter([](const Textable::Row &row) { return row[0].m_data.size() < 3; }).sort(1, TextableView::Order::Descending);
+    EXPECT_LT(allocationCount - before, 16u);
+}
+
+TEST(TypedTextable, SameAsTextable)
+{
+    TypedTextable<TypedColumn<std::string, Textable::Align::Left>,
+                  TypedColumn<int, Textable::Align::Right>,
+                  double,
+                  TypedColumn<bool, Textable::Align::Left>> typed;
+    static_assert(decltype(typed)::columnCount() == 4, "Unexpected column count");
+
+    EXPECT_EQ(typed.toString(), "");
+    EXPECT_EQ(typed.renderedSize(), 0);
+
+    typed.setHeader("Name", "Count", u8"Größe", "Flag");
+    typed.addRow(u8"Երևան", 42, 1.5, true);
+    typed.addRow("Tokyo", -7, 0.25, false);
+    typed.addRow(u8"日本語", 100000, 3.0, true);
+
+    Textable textable;
+    textable.setRow(0, Textable::Align::Left, "Name");
+    textable.setCell(0, 1, Textable::Align::Right, "Count");
+    textable.setCell(0, 2, Textable::Align::Center, u8"Größe");
+    textable.setCell(0, 3, Textable::Align::Left, "Flag");
+    textable.setCell(1, 0, Textable::Align::Left, u8"Երևան");
+    textable.setCell(1, 1, Textable::Align::Right, 42);
+    textable.setCell(1, 2, Textable::Align::Center, 1.5);
+    textable.setCell(1, 3, Textable::Align::Left, true);
+    textable.setCell(2, 0, Textable::Align::Left, "Tokyo");
+    textable.setCell(2, 1, Textable::Align::Right, -7);
+    textable.setCell(2, 2, Textable::Align::Center, 0.25);
+    textable.setCell(2, 3, Textable::Align::Left, false);
+    textable.setCell(3, 0, Textable::Align::Left, u8"日本語");
+    textable.setCell(3, 1, Textable::Align::Right, 100000);
+    textable.setCell(3, 2, Textable::Align::Center, 3.0);
+    textable.setCell(3, 3, Textable::Align::Left, true);
+
+    EXPECT_EQ(typed.rowCount(), 3);
+    EXPECT_EQ(typed.columnWidths(), textable.columnWidths());
+    EXPECT_EQ(typed.renderedSize(), textable.renderedSize());
+    EXPECT_EQ(typed.toString(), textable.toString());
+
+    std::ostringstream stream;
+    stream << typed;
+    EXPECT_EQ(stream.str(), textable.toString());
+
+    std::string buffer(typed.renderedSize() - 1, '#');
+    EXPECT_EQ(typed.renderTo(&buffer[0], buffer.size()), typed.renderedSize());
+    EXPECT_EQ(buffer, std::string(typed.renderedSize() - 1, '#'));
+}
+
+TEST(Parallel, Exceptions)
+{
+    // The exception of any slice is rethrown once all slices are processed.
+    std::atomic<unsigned> done{ 0 };
+    unsigned failing = 0;
+    auto process = [&done, &failing](unsigned slice, size_t, size_t) {
+        if (slice == failing) {
+            throw std::runtime_error("slice");
+        }
+        ++done;
+    };
+
+    for (unsigned slice = 0; slice < 4; ++slice) {
+        done = 0;
+        failing = slice;
+        EXPECT_THROW(parallel::forEachSlice(100, 4, process), std::runtime_error);
+        EXPECT_EQ(done, 3U);
+    }
+}
+
+TEST(Unicode, DisplayWidth)
+{
+    EXPECT_EQ(Unicode::displayWidth(""), 0);
+    EXPECT_EQ(Unicode::displayWidth("ASCII text"), 10);
+    EXPECT_EQ(Unicode::displayWidth(std::string(100, 'a')), 100);
+    EXPECT_EQ(Unicode::displayWidth(u8"Fünf"), 4);
+    EXPECT_EQ(Unicode::displayWidth(u8"Двадцать пять"), 13);
+    EXPECT_EQ(Unicode::displayWidth(u8"Հայաստան"), 8);
+    EXPECT_EQ(Unicode::displayWidth(std::string(40, 'a') + u8"Ü" + std::string(40, 'b')), 81);
+
+    // Wide characters.
+    EXPECT_EQ(Unicode::displayWidth(u8"日本語"), 6);
+    EXPECT_EQ(Unicode::displayWidth(u8"한국어 text"), 11);
+    EXPECT_EQ(Unicode::displayWidth(u8"😀"), 2);
+
+    // Combining and zero width characters.
+    EXPECT_EQ(Unicode::displayWidth("e\xCC\x81"), 1);
+    EXPECT_EQ(Unicode::displayWidth("a\xE2\x80\x8B" "b"), 2);
+
+    // Malformed sequences count as one column per byte.
+    EXPECT_EQ(Unicode::displayWidth("\xFF\xC3"), 2);
+    EXPECT_EQ(Unicode::displayWidth("\xE6\x97"), 2);
+
+    EXPECT_EQ(Unicode::asciiLength("abc\xC3\xBC", 5), 3);
+
+    size_t width = 0;
+    EXPECT_EQ(Unicode::prefixSize(u8"日本語", 9, 5, width), 6);
+    EXPECT_EQ(width, 4);
+    EXPECT_EQ(Unicode::prefixSize("abe\xCC\x81" "cd", 7, 3, width), 5);
+    EXPECT_EQ(width, 3);
+    EXPECT_EQ(Unicode::codePointPrefix("abc", 3, 5), 3);
+    EXPECT_EQ(Unicode::codePointPrefix(u8"日本語", 9, 5), 3);
+    EXPECT_EQ(Unicode::codePointPrefix(u8"日本語", 9, 6), 6);
+    EXPECT_EQ(Unicode::codePointPrefix(u8"aü", 3, 2), 1);
+    EXPECT_EQ(Unicode::codePointPrefix("\x80\x80\x80\x80\x80", 5, 4), 4);
+    EXPECT_EQ(Unicode::codePointWidth(0x4E00), 2);
+    EXPECT_EQ(Unicode::codePointWidth(0x0301), 0);
+    EXPECT_EQ(Unicode::codePointWidth(0x0410), 1);
+}
+
+TEST(Unicode, WideCharacters)
+{
+    Textable textable;
+    textable.setRow(0, Textable::Align::Left, u8"日本", "abcde");
+    textable.setRow(1, Textable::Align::Right, "abc", u8"中文字");
+    EXPECT_EQ(textable.toString(), u8"+------+--------+\n"
+                                   u8"|日本  |abcde   |\n"
+                                   u8"+------+--------+\n"
+                                   u8"|   abc|  中文字|\n"
+                                   u8"+------+--------+\n");
+}
+
+int main(int argc, char**argv)
+{
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }